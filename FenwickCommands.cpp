@@ -0,0 +1,49 @@
+#include <stdexcept>
+
+#include "IO.cpp"
+#include "fenwick.cpp"
+
+// the kattis fenwick problem through io::. reads "n q" and q commands,
+// "+ i delta" adds delta to element i and "? i" writes the sum of [0, i) on
+// its own line. the commands are parsed straight out of the read buffer,
+// which refill keeps at least one whole command ahead. returns the number
+// of commands run, fewer than q if the input ends early. an index outside
+// the tree throws std::out_of_range
+template <class Tree = Fenwick<long long>>
+long long run_fenwick_commands() {
+  int n = 0;
+  long long q = 0;
+  io::read_int(n);
+  io::read_int(q);
+  if (n < 0) throw std::out_of_range("fenwick commands: negative size");
+  Tree fenwick(n);
+  // longest command: "+ " and two 20 character numbers
+  const int kLongest = 64;
+  long long done = 0;
+  for (; done < q; done++) {
+    // the input may hold fewer commands than it announced
+    if (!io::skip_blanks() || io::refill(kLongest) == 0) break;
+    const char* p = io::read_buf + io::read_pos;
+    char op = *p++;
+    auto parse = [&p]() {
+      while (*p == ' ') p++;
+      bool negative = *p == '-';
+      if (negative) p++;
+      long long x = 0;
+      while ('0' <= *p && *p <= '9') x = x * 10 + *p++ - '0';
+      return negative ? -x : x;
+    };
+    // read wide, so an index past int is caught and not wrapped
+    long long i = parse();
+    if (i < 0 || i > n || (op == '+' && i == n)) {
+      throw std::out_of_range("fenwick commands: index outside the tree");
+    }
+    if (op == '+') {
+      fenwick.modify((int)i, parse());
+    } else {
+      io::write_int(fenwick.query((int)i), '\n');
+    }
+    io::read_pos = p - io::read_buf;
+  }
+  return done;
+}
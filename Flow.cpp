@@ -8,6 +8,11 @@
 // based on the following
 // https://github.com/jaehyunp/stanfordacm/blob/master/code/Dinic.cc
 
+// how Flow::max_flow pushes the flow. Dinic is fine on sparse and unit
+// graphs, highest label push relabel with the gap and global relabeling
+// heuristics is usually much faster on large dense or grid graphs
+enum class FlowAlgorithm { kDinic, kPushRelabel };
+
 template <class I, class E>
 struct Edge {
   I u, v;
@@ -25,7 +30,16 @@ class Flow {
   I* level;
   I* last_visited;
   E INF;
-  Flow(I n) : n(n), Edges(0), Graph(n) {
+  FlowAlgorithm algorithm;
+  // compressed copy of the graph for Dinic, built by freeze. the arcs out
+  // of u are offset[u] to offset[u + 1], arc p goes to to[p] with residual
+  // capacity residual[p], its reverse is arc rev[p] and both stand for
+  // Edges[edge_index[p]]
+  bool frozen;
+  std::vector<I> offset, to, rev, edge_index;
+  std::vector<E> residual;
+  Flow(I n, FlowAlgorithm algorithm = FlowAlgorithm::kDinic)
+      : n(n), Edges(0), Graph(n), algorithm(algorithm), frozen(false) {
     Edges.reserve(2 * n - 2);
     memset(&INF, 0x3f, sizeof(E));
     level = new I[n];
@@ -37,8 +51,33 @@ class Flow {
       Graph[u].push_back(Edges.size() - 1);
       Edges.push_back(Edge<I, E>(v, u, 0));
       Graph[v].push_back(Edges.size() - 1);
+      frozen = false;
     }
   }
+  // lays the arcs out vertex by vertex for a faster Dinic. Edges stays the
+  // source of truth: max_flow loads the residuals from it and writes the
+  // flows back, and add_edge drops the compressed copy. an arc and its
+  // reverse leave different vertices, so they cannot sit side by side
+  void freeze() {
+    I arcs = Edges.size();
+    offset.assign(n + 1, 0);
+    to.resize(arcs), rev.resize(arcs), edge_index.resize(arcs);
+    residual.resize(arcs);
+    std::vector<I> position(arcs);
+    for (I u = 0; u < n; u++) {
+      offset[u + 1] = offset[u] + Graph[u].size();
+      for (I i = 0; i < (I)Graph[u].size(); i++) {
+        position[Graph[u][i]] = offset[u] + i;
+      }
+    }
+    for (I e = 0; e < arcs; e++) {
+      I p = position[e];
+      to[p] = Edges[e].v;
+      rev[p] = position[e ^ 1];
+      edge_index[p] = e;
+    }
+    frozen = true;
+  }
   ~Flow() {
     Edges.clear();
     Graph.clear();
@@ -63,30 +102,273 @@ class Flow {
     }
     return level[t] < n;
   }
-  E dfs(I u, I t, E flow) {
-    if (u == t || flow == 0) return flow;
-    for (I& i = last_visited[u]; i < Graph[u].size(); i++) {
-      Edge<I, E>& for_edge = Edges[Graph[u][i]];
-      Edge<I, E>& rev_edge = Edges[Graph[u][i] ^ 1];
-      if (level[for_edge.v] == level[for_edge.u] + 1 &&
-          for_edge.capacity > for_edge.flow) {
-        if (E pushed = dfs(for_edge.v, t,
-                           std::min(flow, for_edge.capacity - for_edge.flow))) {
-          for_edge.flow += pushed, rev_edge.flow -= pushed;
-          return pushed;
+  // pushes a blocking flow through the level graph with an explicit stack
+  // of arcs from s. after each augmenting path it only retreats to the
+  // tail of the first arc that got saturated, so one call pushes along
+  // many paths, and last_visited skips the arcs known to be dead
+  E blocking_flow(I s, I t) {
+    E total = 0;
+    std::vector<I> path;
+    I u = s;
+    while (true) {
+      if (u == t) {
+        // no INF cap, so the bottleneck arc always saturates
+        E pushed = Edges[path[0]].capacity - Edges[path[0]].flow;
+        for (I e : path) {
+          pushed = std::min(pushed, Edges[e].capacity - Edges[e].flow);
+        }
+        size_t saturated = path.size();
+        for (size_t k = 0; k < path.size(); k++) {
+          Edge<I, E>& edge = Edges[path[k]];
+          edge.flow += pushed, Edges[path[k] ^ 1].flow -= pushed;
+          if (edge.flow == edge.capacity && saturated == path.size()) {
+            saturated = k;
+          }
+        }
+        total += pushed;
+        u = Edges[path[saturated]].u;
+        path.resize(saturated);
+        continue;
+      }
+      I& i = last_visited[u];
+      for (; i < (I)Graph[u].size(); i++) {
+        Edge<I, E>& edge = Edges[Graph[u][i]];
+        if (level[edge.v] == level[u] + 1 && edge.flow < edge.capacity) break;
+      }
+      if (i < (I)Graph[u].size()) {
+        path.push_back(Graph[u][i]);
+        u = Edges[Graph[u][i]].v;
+      } else {
+        // dead end, the arc into u is useless for the rest of the phase
+        if (u == s) break;
+        u = Edges[path.back()].u;
+        path.pop_back();
+        last_visited[u]++;
+      }
+    }
+    return total;
+  }
+  bool bfs_frozen(I s, I t) {
+    memset(level, 0x3f, sizeof(I) * n);
+    std::queue<I> q({s});
+    level[s] = 0;
+    while (!q.empty()) {
+      I u = q.front();
+      q.pop();
+      if (u == t) break;
+      for (I p = offset[u]; p < offset[u + 1]; p++) {
+        if (residual[p] > 0 && level[to[p]] > level[u] + 1) {
+          level[to[p]] = level[u] + 1;
+          q.push(to[p]);
         }
       }
     }
-    return 0;
+    return level[t] < n;
+  }
+  // blocking_flow over the frozen arrays. the tail of arc p is
+  // to[rev[p]]
+  E blocking_flow_frozen(I s, I t) {
+    E total = 0;
+    std::vector<I> path;
+    I u = s;
+    while (true) {
+      if (u == t) {
+        E pushed = residual[path[0]];
+        for (I p : path) pushed = std::min(pushed, residual[p]);
+        size_t saturated = path.size();
+        for (size_t k = 0; k < path.size(); k++) {
+          I p = path[k];
+          residual[p] -= pushed, residual[rev[p]] += pushed;
+          if (residual[p] == 0 && saturated == path.size()) saturated = k;
+        }
+        total += pushed;
+        u = to[rev[path[saturated]]];
+        path.resize(saturated);
+        continue;
+      }
+      I& p = last_visited[u];
+      for (; p < offset[u + 1]; p++) {
+        if (level[to[p]] == level[u] + 1 && residual[p] > 0) break;
+      }
+      if (p < offset[u + 1]) {
+        path.push_back(p);
+        u = to[p];
+      } else {
+        if (u == s) break;
+        u = to[rev[path.back()]];
+        path.pop_back();
+        last_visited[u]++;
+      }
+    }
+    return total;
+  }
+  E max_flow_frozen(I s, I t) {
+    I arcs = Edges.size();
+    for (I p = 0; p < arcs; p++) {
+      Edge<I, E>& edge = Edges[edge_index[p]];
+      residual[p] = edge.capacity - edge.flow;
+    }
+    E total = 0;
+    while (bfs_frozen(s, t)) {
+      memcpy(last_visited, offset.data(), sizeof(I) * n);
+      total += blocking_flow_frozen(s, t);
+    }
+    for (I p = 0; p < arcs; p++) {
+      Edge<I, E>& edge = Edges[edge_index[p]];
+      edge.flow = edge.capacity - residual[p];
+    }
+    return total;
   }
   E max_flow(I s, I t) {
+    if (s == t) return 0;
+    if (algorithm == FlowAlgorithm::kPushRelabel) return push_relabel(s, t);
+    if (frozen) return max_flow_frozen(s, t);
     E total = 0;
     while (bfs(s, t)) {
       memset(last_visited, 0, sizeof(I) * n);
-      while (E flo = dfs(s, t, INF)) {
-        total += flo;
-      }
+      total += blocking_flow(s, t);
     }
     return total;
   }
+
+  // highest label push relabel, starting from the flow already in Edges.
+  // the first phase moves all the excess it can to t with labels below n,
+  // the distances to t. the second one sends what is left back to s with
+  // labels n plus the distance to s, so Edges ends up holding a valid
+  // maximum flow, like after Dinic
+  E push_relabel(I s, I t) {
+    std::vector<E> excess(n);
+    std::vector<I> height(n);
+    // active[h] holds the vertices with excess at height h. the vertices
+    // below n are also linked by height, to find them all on a gap
+    std::vector<std::vector<I>> active(2 * n);
+    std::vector<I> head(n), next(n), prev(n);
+    // only labels below limit are active in the current phase
+    I limit = n, highest = 0, highest_linked = 0;
+    long long work = 0;
+    const long long relabel_period = 6ll * n + Edges.size();
+    auto link = [&](I v) {
+      I h = height[v];
+      next[v] = head[h], prev[v] = -1;
+      if (head[h] >= 0) prev[head[h]] = v;
+      head[h] = v;
+      highest_linked = std::max(highest_linked, h);
+    };
+    auto unlink = [&](I v) {
+      if (prev[v] >= 0) {
+        next[prev[v]] = next[v];
+      } else {
+        head[height[v]] = next[v];
+      }
+      if (next[v] >= 0) prev[next[v]] = prev[v];
+    };
+    auto activate = [&](I v) {
+      if (height[v] < limit) {
+        active[height[v]].push_back(v);
+        highest = std::max(highest, height[v]);
+      }
+    };
+    // exact labels from two reverse bfs over the residual graph, one from
+    // t and one from s. what neither reaches has no excess left to move
+    auto global_relabel = [&]() {
+      std::fill(height.begin(), height.end(), 2 * n);
+      std::fill(head.begin(), head.end(), -1);
+      for (auto& bucket : active) bucket.clear();
+      highest = highest_linked = 0;
+      height[t] = 0, height[s] = n;
+      for (I root : {t, s}) {
+        std::queue<I> q({root});
+        while (!q.empty()) {
+          I u = q.front();
+          q.pop();
+          if (height[u] < n) link(u);
+          for (I e : Graph[u]) {
+            I v = Edges[e].v;
+            Edge<I, E>& back = Edges[e ^ 1];
+            if (height[v] == 2 * n && back.flow < back.capacity) {
+              height[v] = height[u] + 1;
+              q.push(v);
+            }
+          }
+        }
+      }
+      for (I v = 0; v < n; v++) {
+        last_visited[v] = 0;
+        if (excess[v] > 0 && v != s && v != t) activate(v);
+      }
+      work = 0;
+    };
+    auto push = [&](I u, I e) {
+      Edge<I, E>& edge = Edges[e];
+      E delta = std::min(excess[u], edge.capacity - edge.flow);
+      edge.flow += delta, Edges[e ^ 1].flow -= delta;
+      excess[u] -= delta;
+      if (excess[edge.v] == 0 && edge.v != s && edge.v != t) {
+        activate(edge.v);
+      }
+      excess[edge.v] += delta;
+    };
+    // nothing from h up can reach t any more, so all of it waits at n for
+    // the second phase
+    auto gap = [&](I h) {
+      for (I g = h; g <= highest_linked; g++) {
+        for (I v = head[g]; v >= 0; v = next[v]) height[v] = n;
+        head[g] = -1;
+        active[g].clear();
+      }
+      highest_linked = h - 1;
+    };
+    auto relabel = [&](I u) {
+      I h = 2 * n;
+      for (I e : Graph[u]) {
+        Edge<I, E>& edge = Edges[e];
+        if (edge.flow < edge.capacity) h = std::min(h, height[edge.v] + 1);
+      }
+      work += Graph[u].size() + 12;
+      last_visited[u] = 0;
+      if (height[u] < n) unlink(u);
+      height[u] = h;
+      if (h < n) link(u);
+    };
+    auto discharge = [&](I u) {
+      while (excess[u] > 0 && height[u] < limit) {
+        if (last_visited[u] == (I)Graph[u].size()) {
+          I h = height[u];
+          if (h < n && head[h] == u && next[u] < 0) {
+            gap(h);
+          } else {
+            relabel(u);
+          }
+          continue;
+        }
+        I e = Graph[u][last_visited[u]];
+        Edge<I, E>& edge = Edges[e];
+        if (edge.flow < edge.capacity && height[u] == height[edge.v] + 1) {
+          push(u, e);
+        } else {
+          last_visited[u]++;
+        }
+      }
+    };
+
+    for (I e : Graph[s]) {
+      Edge<I, E>& edge = Edges[e];
+      excess[s] += edge.capacity - edge.flow;
+    }
+    for (I e : Graph[s]) {
+      if (Edges[e].flow < Edges[e].capacity) push(s, e);
+    }
+    for (; limit <= 2 * n; limit += n) {
+      global_relabel();
+      while (true) {
+        while (highest > 0 && active[highest].empty()) highest--;
+        if (active[highest].empty()) break;
+        I u = active[highest].back();
+        active[highest].pop_back();
+        discharge(u);
+        if (work > relabel_period) global_relabel();
+      }
+    }
+    return excess[t];
+  }
 };
@@ -1,12 +1,23 @@
+// included by other library files too
+#pragma once
+#include <cstdio>
+#include <cstring>
 #include <string>
 
 namespace io {
 
 static const int buf_size = 1 << 22;
-static char read_buf[buf_size];
+// one extra byte for the terminator refill puts after the input
+static char read_buf[buf_size + 1];
 static char write_buf[buf_size];
 
 static int read_len = 0, read_pos = 0, write_pos = 0;
+static FILE* input = stdin;
+static FILE* output = stdout;
+
+inline void set_input(FILE* file);
+inline void set_output(FILE* file);
+inline int refill(int count);
 
 inline bool is_blank(char c);
 inline bool skip_blanks();
@@ -27,27 +38,49 @@ inline void write_word(const char* s);
 inline void write_double(double x, int digits);
 inline void write_string(const std::string& s);
 
+// drops what is buffered from the previous input
+inline void set_input(FILE* file) {
+  input = file;
+  read_len = read_pos = 0;
+}
+
+// makes sure at least count bytes, or all that is left of the input, are
+// buffered from read_buf + read_pos on and returns how many are. a 0 byte
+// follows them, so a parser can run over the chunk without bound checks
+inline int refill(int count) {
+  if (read_len - read_pos < count) {
+    memmove(read_buf, read_buf + read_pos, read_len - read_pos);
+    read_len -= read_pos;
+    read_pos = 0;
+    read_len += fread(read_buf + read_len, 1, buf_size - read_len, input);
+  }
+  read_buf[read_len] = 0;
+  return read_len - read_pos;
+}
+
 inline char get_char() {
   if (read_pos == read_len)
-    read_pos = 0, read_len = fread(read_buf, 1, buf_size, stdin);
+    read_pos = 0, read_len = fread(read_buf, 1, buf_size, input);
   if (read_pos == read_len) return -1;
   return read_buf[read_pos++];
 }
 
 inline char peek_char() {
   if (read_pos == read_len)
-    read_pos = 0, read_len = fread(read_buf, 1, buf_size, stdin);
+    read_pos = 0, read_len = fread(read_buf, 1, buf_size, input);
   if (read_pos == read_len) return -1;
   return read_buf[read_pos];
 }
 
 inline bool is_blank(char c) { return (c <= ' ' && c); }
 
+// false at the end of the input
 inline bool skip_blanks() {
-  while (is_blank(peek_char())) {
+  char c;
+  while ((c = peek_char()) != -1 && is_blank(c)) {
     get_char();
   }
-  return peek_char() != 0;
+  return c != 0 && c != -1;
 }
 
 inline char read_char() {
@@ -87,7 +120,7 @@ inline void read_string(std::string& s) {
 
 inline void write_char(char x) {
   if (write_pos == buf_size)
-    fwrite(write_buf, 1, buf_size, stdout), write_pos = 0;
+    fwrite(write_buf, 1, buf_size, output), write_pos = 0;
   write_buf[write_pos++] = x;
 }
 
@@ -120,8 +153,14 @@ inline void write_string(const std::string& s) {
 struct Flusher {
   ~Flusher() { Flusher::flush(); }
   static void flush() {
-    if (write_pos) fwrite(write_buf, 1, write_pos, stdout), write_pos = 0;
+    if (write_pos) fwrite(write_buf, 1, write_pos, output), write_pos = 0;
   }
 } flusher;
 
+// writes out what is buffered for the previous output first
+inline void set_output(FILE* file) {
+  Flusher::flush();
+  output = file;
+}
+
 }  // namespace io
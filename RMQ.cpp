@@ -0,0 +1,102 @@
+// static range queries over read-only arrays, with the same interface as
+// SegmentTree: ranges are left inclusive, right exclusive and M is any
+// merger with identity() and merge(left, right), such as MyMin or MyMax
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// O(n log n) memory, O(1) query. M must be idempotent, merge(x, x) == x,
+// since a query merges two overlapping powers of two
+template <class I, class E, class M>
+class SparseTable {
+  // level k holds the merged value of [i, i + 2^k) at offset[k] + i
+  std::vector<E> table;
+  std::vector<size_t> offset;
+  M merger;
+  I n;
+
+ public:
+  SparseTable() : n(0) {}
+  SparseTable(const std::vector<E>& elements, const M& merger = M())
+      : merger(merger), n(elements.size()) {
+    table = elements;
+    offset.push_back(0);
+    for (I k = 1; ((I)1 << k) <= n; k++) {
+      size_t previous = offset.back();
+      offset.push_back(table.size());
+      I half = (I)1 << (k - 1);
+      for (I i = 0; i + 2 * half <= n; i++) {
+        table.push_back(this->merger.merge(table[previous + i],
+                                           table[previous + i + half]));
+      }
+    }
+  }
+  E query(I l, I r) const {
+    if (l >= r) return merger.identity();
+    int k = 63 - __builtin_clzll(r - l);
+    return merger.merge(table[offset[k] + l],
+                        table[offset[k] + r - ((I)1 << k)]);
+  }
+  size_t bytes() const {
+    return table.size() * sizeof(E) + offset.size() * sizeof(size_t);
+  }
+};
+
+// O(n) memory, O(1) query. the array is cut into blocks of 64 with a
+// SparseTable over the block values. inside a block, bit j of mask[i] is
+// set when element j is still a candidate for the ranges ending at i,
+// i.e. no element in (j, i] beats it, so the answer for [l, i] is the
+// lowest bit of mask[i] at or above l. M must pick one of its arguments,
+// like MyMin or MyMax
+template <class I, class E, class M>
+class BlockRMQ {
+  static const int kBlock = 64;
+  std::vector<E> elements;
+  std::vector<uint64_t> mask;
+  SparseTable<I, E, M> blocks;
+  M merger;
+  I n;
+
+  // best of [l, r] within one block
+  E in_block(I l, I r) const {
+    uint64_t candidates = mask[r] & (~0ull << (l % kBlock));
+    return elements[r - r % kBlock + __builtin_ctzll(candidates)];
+  }
+
+ public:
+  BlockRMQ() : n(0) {}
+  BlockRMQ(const std::vector<E>& elements, const M& merger = M())
+      : elements(elements), merger(merger), n(elements.size()) {
+    mask.resize(n);
+    std::vector<E> best;
+    for (I start = 0; start < n; start += kBlock) {
+      uint64_t stack = 0;
+      for (I i = start; i < n && i < start + kBlock; i++) {
+        const E& x = elements[i];
+        // drop the candidates x beats
+        while (stack != 0) {
+          I top = start + 63 - __builtin_clzll(stack);
+          if (this->merger.merge(elements[top], x) == elements[top]) break;
+          stack ^= 1ull << (top - start);
+        }
+        stack |= 1ull << (i - start);
+        mask[i] = stack;
+      }
+      best.push_back(elements[start + __builtin_ctzll(stack)]);
+    }
+    blocks = SparseTable<I, E, M>(best, merger);
+  }
+  E query(I l, I r) const {
+    if (l >= r) return merger.identity();
+    r--;
+    I bl = l / kBlock, br = r / kBlock;
+    if (bl == br) return in_block(l, r);
+    E res = merger.merge(in_block(l, bl * kBlock + kBlock - 1),
+                         blocks.query(bl + 1, br));
+    return merger.merge(res, in_block(br * kBlock, r));
+  }
+  size_t bytes() const {
+    return elements.size() * sizeof(E) + mask.size() * sizeof(uint64_t) +
+           blocks.bytes();
+  }
+};
@@ -1,8 +1,23 @@
 // based on http://codeforces.com/blog/entry/18051
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SEGMENT_TREE_AVX2
+#endif
 
+// the trees are templated on the merger type M, anything with identity()
+// and merge(left, right). the mergers below are final, so calls through a
+// tree holding one by value are resolved at compile time and inlined
 template <class E>
 struct Merger {
   virtual E identity() const = 0;
@@ -10,23 +25,48 @@ struct Merger {
 };
 
 template <class E>
-struct MyMin : public Merger<E> {
+struct MyMin final : public Merger<E> {
   E identity() const { return std::numeric_limits<E>::max(); }
   E merge(const E& left, const E& right) const { return std::min(left, right); }
 };
 
 template <class E>
-struct MyMax : public Merger<E> {
+struct MyMax final : public Merger<E> {
   E identity() const { return std::numeric_limits<E>::lowest(); }
   E merge(const E& left, const E& right) const { return std::max(left, right); }
 };
 
 template <class E>
-struct MySum : public Merger<E> {
+struct MySum final : public Merger<E> {
   E identity() const { return (E)0; }
   E merge(const E& left, const E& right) const { return left + right; }
 };
 
+// type-erased merger for mergers chosen at runtime, every call goes through
+// the vtable. the referenced merger must outlive the tree. it has no default
+// constructor, so a tree over elements can't be built without one
+template <class E>
+struct DynamicMerger {
+  const Merger<E>* merger;
+  explicit DynamicMerger(std::nullptr_t) : merger(nullptr) {}
+  DynamicMerger(const Merger<E>& merger) : merger(&merger) {}
+  E identity() const { return merger->identity(); }
+  E merge(const E& left, const E& right) const {
+    return merger->merge(left, right);
+  }
+};
+
+// the merger of a tree constructed empty, which has to be assigned before
+// use. a DynamicMerger holds no merger then
+template <class M>
+struct UnsetMerger {
+  static M get() { return M(); }
+};
+template <class E>
+struct UnsetMerger<DynamicMerger<E>> {
+  static DynamicMerger<E> get() { return DynamicMerger<E>(nullptr); }
+};
+
 struct Element {
   // length, leftValue, leftFrequency, rightValue, rightFrequency,
   // middleValue, MiddleFrequency;
@@ -87,67 +127,400 @@ struct Frequency : public Merger<Element> {
   }
 };
 
-// UVA 11297
+// the internal nodes to remerge after setting the leaves of updates in a
+// tree with n leaves, deduplicated and grouped by depth in increasing
+// order, so merging from the last depth up reproduces calling modify for
+// every update. the leaves sit on two depths when n is not a power of two
 template <class I, class E>
+std::vector<std::vector<I>> dirty_ancestors(
+    const std::vector<std::pair<I, E>>& updates, I n) {
+  std::vector<std::vector<I>> depth;
+  for (auto& update : updates) {
+    I i = (update.first + n) >> 1;
+    if (i == 0) continue;
+    size_t d = 63 - __builtin_clzll(i);
+    if (d >= depth.size()) depth.resize(d + 1);
+    depth[d].push_back(i);
+  }
+  for (size_t d = depth.size(); d-- > 0;) {
+    std::vector<I>& nodes = depth[d];
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    if (d > 0) {
+      for (I i : nodes) depth[d - 1].push_back(i >> 1);
+    }
+  }
+  return depth;
+}
+
+// UVA 11297
+template <class I, class E, class M = DynamicMerger<E>>
 class SegmentTree {
   std::vector<E> tree;
-  const Merger<E>* merger;
+  M merger;
   I n;
 
  public:
-  SegmentTree() {}
-  SegmentTree(const std::vector<E>& elements, const Merger<E>& merger) {
-    n = elements.size();
+  SegmentTree() : merger(UnsetMerger<M>::get()), n(0) {}
+  SegmentTree(const std::vector<E>& elements, const M& merger = M(),
+              int threads = 1)
+      : merger(merger) {
+    reload(elements.data(), elements.data() + elements.size(), threads);
+  }
+  // takes over the storage of elements, which is only reallocated if its
+  // capacity is below 2 * size
+  SegmentTree(std::vector<E>&& elements, const M& merger = M(),
+              int threads = 1)
+      : tree(std::move(elements)), merger(merger) {
+    n = tree.size();
     tree.resize(2 * n);
-    this->merger = &merger;
-    for (I i = n; i < 2 * n; i++) {
-      tree[i] = elements[i - n];
-    }
-    for (I i = n - 1; i > 0; i--) {
-      tree[i] = this->merger->merge(tree[i << 1], tree[(i << 1) | 1]);
-    }
+    std::move_backward(tree.begin(), tree.begin() + n, tree.end());
+    build(threads);
+  }
+  // rebuilds the tree over [first, last), reusing the storage
+  void reload(const E* first, const E* last, int threads = 1) {
+    n = last - first;
+    tree.resize(2 * n);
+    std::copy(first, last, tree.begin() + n);
+    build(threads);
   }
   ~SegmentTree() { tree.clear(); }
   void modify(I i, const E& value) {
     for (tree[i += n] = value; i >>= 1;) {
-      tree[i] = merger->merge(tree[i << 1], tree[(i << 1) | 1]);
+      tree[i] = merger.merge(tree[i << 1], tree[(i << 1) | 1]);
     }
   }
   // left inclusive, right exclusive
-  E query(I l, I r) {
-    E resl = merger->identity();
-    E resr = merger->identity();
+  E query(I l, I r) const {
+    E resl = merger.identity();
+    E resr = merger.identity();
     for (l += n, r += n; l < r; l >>= 1, r >>= 1) {
-      if (l & 1) resl = merger->merge(resl, tree[l++]);
-      if (r & 1) resr = merger->merge(tree[--r], resr);
+      if (l & 1) resl = merger.merge(resl, tree[l++]);
+      if (r & 1) resr = merger.merge(tree[--r], resr);
+    }
+    return merger.merge(resl, resr);
+  }
+  // largest r such that pred(query(l, r)) holds, for a pred that holds on
+  // the identity and stays false once it turns false as r grows. the
+  // nodes making up [l, n) are checked left to right and the first one
+  // that fails is descended, so it takes O(log n) merges
+  template <class P>
+  I max_right(I l, P pred) const {
+    I nodes[128];
+    int count = decompose(l, n, nodes);
+    E acc = merger.identity();
+    for (int k = 0; k < count; k++) {
+      I i = nodes[k];
+      E next = merger.merge(acc, tree[i]);
+      if (pred(next)) {
+        acc = next;
+        continue;
+      }
+      while (i < n) {
+        i <<= 1;
+        next = merger.merge(acc, tree[i]);
+        if (pred(next)) {
+          acc = next;
+          i++;
+        }
+      }
+      return i - n;
+    }
+    return n;
+  }
+  // smallest l such that pred(query(l, r)), the mirror of max_right
+  template <class P>
+  I min_left(I r, P pred) const {
+    I nodes[128];
+    int count = decompose(0, r, nodes);
+    E acc = merger.identity();
+    for (int k = count - 1; k >= 0; k--) {
+      I i = nodes[k];
+      E next = merger.merge(tree[i], acc);
+      if (pred(next)) {
+        acc = next;
+        continue;
+      }
+      while (i < n) {
+        i = (i << 1) | 1;
+        next = merger.merge(tree[i], acc);
+        if (pred(next)) {
+          acc = next;
+          i--;
+        }
+      }
+      return i + 1 - n;
+    }
+    return 0;
+  }
+  // leaves the tree as calling modify for every update in order would, but
+  // each ancestor is merged once
+  void modify_batch(const std::vector<std::pair<I, E>>& updates) {
+    for (auto& update : updates) {
+      tree[update.first + n] = update.second;
+    }
+    std::vector<std::vector<I>> depth = dirty_ancestors(updates, n);
+    for (size_t d = depth.size(); d-- > 0;) {
+      for (I i : depth[d]) {
+        tree[i] = merger.merge(tree[i << 1], tree[(i << 1) | 1]);
+      }
+    }
+  }
+  // results[k] = query(queries[k].first, queries[k].second). while answering
+  // query k the lower ancestors of query k + 16 are prefetched, so their
+  // cache misses overlap. with threads > 1 the batch is split into
+  // contiguous chunks
+  void query_batch(const std::vector<std::pair<I, I>>& queries,
+                   std::vector<E>& results, int threads = 1) const {
+    results.resize(queries.size());
+    size_t chunk = (queries.size() + threads - 1) / std::max(threads, 1);
+    if (threads <= 1 || chunk < 4096) {
+      query_range(queries, results, 0, queries.size());
+      return;
+    }
+    std::vector<std::thread> workers;
+    for (size_t from = 0; from < queries.size(); from += chunk) {
+      size_t to = std::min(queries.size(), from + chunk);
+      workers.emplace_back([&, from, to] {
+        query_range(queries, results, from, to);
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+ private:
+  // merges the internal nodes level by level from the deepest, splitting
+  // the large levels across threads
+  void build(int threads) {
+    for (I end = n; end > 1;) {
+      I begin = (I)1 << (63 - __builtin_clzll(end - 1));
+      auto merge_range = [this](I from, I to) {
+        for (I i = from; i < to; i++) {
+          tree[i] = merger.merge(tree[i << 1], tree[(i << 1) | 1]);
+        }
+      };
+      I chunk = (end - begin + threads - 1) / std::max(threads, 1);
+      if (threads <= 1 || chunk < (1 << 16)) {
+        merge_range(begin, end);
+      } else {
+        std::vector<std::thread> workers;
+        for (I from = begin; from < end; from += chunk) {
+          workers.emplace_back(merge_range, from, std::min(end, from + chunk));
+        }
+        for (auto& worker : workers) {
+          worker.join();
+        }
+      }
+      end = begin;
+    }
+  }
+  // the nodes query(l, r) merges, left to right
+  int decompose(I l, I r, I* nodes) const {
+    I right[64];
+    int count = 0, count_right = 0;
+    for (l += n, r += n; l < r; l >>= 1, r >>= 1) {
+      if (l & 1) nodes[count++] = l++;
+      if (r & 1) right[count_right++] = --r;
+    }
+    while (count_right > 0) {
+      nodes[count++] = right[--count_right];
+    }
+    return count;
+  }
+  void query_range(const std::vector<std::pair<I, I>>& queries,
+                   std::vector<E>& results, size_t from, size_t to) const {
+    const size_t D = 16;
+    for (size_t k = from; k < to; k++) {
+      if (k + D < to) {
+        I l = queries[k + D].first + n, r = queries[k + D].second + n - 1;
+        for (int j = 0; j < 12 && l <= r; j++, l >>= 1, r >>= 1) {
+          __builtin_prefetch(&tree[l]);
+          __builtin_prefetch(&tree[r]);
+        }
+      }
+      results[k] = query(queries[k].first, queries[k].second);
     }
-    return merger->merge(resl, resr);
+  }
+};
+
+// tree of trees over a grid, stored flat: row x of the outer tree is a 1D
+// tree over the columns at tree[x * 2 * m]. the outer rows follow the same
+// bottom-up layout as SegmentTree, so updates and queries are two nested
+// loops with no recursion. cells are merged row by row, so M should be
+// commutative (MySum, MyMin, MyMax)
+// UVA 11297
+template <class I, class E, class M = DynamicMerger<E>>
+class SegmentTree2D {
+  std::vector<E> tree;
+  M merger;
+  I n, m;
+
+  E& at(I x, I y) { return tree[(size_t)x * 2 * m + y]; }
+  const E& at(I x, I y) const { return tree[(size_t)x * 2 * m + y]; }
+
+ public:
+  SegmentTree2D() : merger(UnsetMerger<M>::get()), n(0), m(0) {}
+  SegmentTree2D(const std::vector<std::vector<E>>& grid, const M& merger = M())
+      : merger(merger) {
+    n = grid.size();
+    m = n > 0 ? grid[0].size() : 0;
+    tree.resize((size_t)4 * n * m);
+    for (I x = n; x < 2 * n; x++) {
+      for (I y = m; y < 2 * m; y++) {
+        at(x, y) = grid[x - n][y - m];
+      }
+      for (I y = m - 1; y > 0; y--) {
+        at(x, y) = this->merger.merge(at(x, y << 1), at(x, (y << 1) | 1));
+      }
+    }
+    for (I x = n - 1; x > 0; x--) {
+      for (I y = 1; y < 2 * m; y++) {
+        at(x, y) = this->merger.merge(at(x << 1, y), at((x << 1) | 1, y));
+      }
+    }
+  }
+  void modify(I x, I y, const E& value) {
+    x += n;
+    y += m;
+    at(x, y) = value;
+    for (I j = y >> 1; j > 0; j >>= 1) {
+      at(x, j) = merger.merge(at(x, j << 1), at(x, (j << 1) | 1));
+    }
+    for (x >>= 1; x > 0; x >>= 1) {
+      for (I j = y; j > 0; j >>= 1) {
+        at(x, j) = merger.merge(at(x << 1, j), at((x << 1) | 1, j));
+      }
+    }
+  }
+  // rows [x1, x2) and columns [y1, y2)
+  E query(I x1, I y1, I x2, I y2) const {
+    E res = merger.identity();
+    for (x1 += n, x2 += n; x1 < x2; x1 >>= 1, x2 >>= 1) {
+      if (x1 & 1) res = merger.merge(res, query_row(x1++, y1, y2));
+      if (x2 & 1) res = merger.merge(res, query_row(--x2, y1, y2));
+    }
+    return res;
+  }
+
+ private:
+  E query_row(I x, I l, I r) const {
+    E res = merger.identity();
+    for (l += m, r += m; l < r; l >>= 1, r >>= 1) {
+      if (l & 1) res = merger.merge(res, at(x, l++));
+      if (r & 1) res = merger.merge(res, at(x, --r));
+    }
+    return res;
+  }
+};
+
+// range updates for SegmentTreeLazy. F is the update type, identity() the
+// update that changes nothing, compose(f, g) applies g first and then f,
+// and apply(f, x, length) updates the merged value x of length elements.
+// every action only fits the merger it is named after
+
+// value * length for the actions that scale by the length. integers are
+// multiplied modulo 2^bits, so even the 2^63 keys under the root of a
+// SparseSegmentTree cannot overflow, and the sums that fit in E stay exact
+template <class E>
+E scale(const E& value, uint64_t length) {
+  if constexpr (std::is_integral<E>::value) {
+    typedef typename std::make_unsigned<E>::type U;
+    return (E)((U)value * (U)length);
+  } else {
+    return value * (E)length;
+  }
+}
+
+template <class E>
+struct AddSum {
+  typedef E F;
+  F identity() const { return (F)0; }
+  F compose(const F& f, const F& g) const { return f + g; }
+  E apply(const F& f, const E& x, uint64_t length) const {
+    return x + scale(f, length);
+  }
+};
+
+// range add over MyMin or MyMax
+template <class E>
+struct AddMinMax {
+  typedef E F;
+  F identity() const { return (F)0; }
+  F compose(const F& f, const F& g) const { return f + g; }
+  E apply(const F& f, const E& x, uint64_t) const { return x + f; }
+};
+
+// range assign, `set` is false for the identity
+template <class E>
+struct Assignment {
+  bool set;
+  E value;
+  Assignment(bool set = false, E value = E()) : set(set), value(value) {}
+};
+
+template <class E>
+struct AssignSum {
+  typedef Assignment<E> F;
+  F identity() const { return F(); }
+  F compose(const F& f, const F& g) const { return f.set ? f : g; }
+  E apply(const F& f, const E& x, uint64_t length) const {
+    return f.set ? scale(f.value, length) : x;
+  }
+};
+
+// range assign over MyMin or MyMax
+template <class E>
+struct AssignMinMax {
+  typedef Assignment<E> F;
+  F identity() const { return F(); }
+  F compose(const F& f, const F& g) const { return f.set ? f : g; }
+  E apply(const F& f, const E& x, uint64_t) const {
+    return f.set ? f.value : x;
+  }
+};
+
+// x -> a * x + b over MySum
+template <class E>
+struct Affine {
+  E a, b;
+  Affine(E a = 1, E b = 0) : a(a), b(b) {}
+};
+
+template <class E>
+struct AffineSum {
+  typedef Affine<E> F;
+  F identity() const { return F(); }
+  F compose(const F& f, const F& g) const {
+    return F(f.a * g.a, f.a * g.b + f.b);
+  }
+  E apply(const F& f, const E& x, uint64_t length) const {
+    return f.a * x + scale(f.b, length);
   }
 };
 
 // UVA 11402
 // ranges are left inclusive, right exclusive
-template <class I, class E>
+template <class I, class E, class M = MySum<E>, class A = AddSum<E>>
 class SegmentTreeLazy {
+  typedef typename A::F F;
   std::vector<E> tree;
-  E* pending;
-  const Merger<E>* merger;
+  std::vector<F> pending;
+  // pending[i] holds an update not yet pushed to the children of i
+  std::vector<char> dirty;
+  M merger;
+  A action;
   I height;
   I n;
 
  public:
   SegmentTreeLazy() {}
-  SegmentTreeLazy(I n) : n(n), height(0) {
-    I np = n;
-    while (np > 0) {
-      np >>= 1;
-      height++;
-    }
-    pending = new E[n]();
-    tree.resize(2 * n);
-    this->merger = new MySum<E>();
-  }
-  SegmentTreeLazy(const std::vector<E>& elements, const Merger<E>& merger) {
+  SegmentTreeLazy(I n, const M& merger = M(), const A& action = A())
+      : SegmentTreeLazy(std::vector<E>(n), merger, action) {}
+  SegmentTreeLazy(const std::vector<E>& elements, const M& merger = M(),
+                  const A& action = A())
+      : merger(merger), action(action) {
     n = elements.size();
     I np = n;
     height = 0;
@@ -155,25 +528,22 @@ class SegmentTreeLazy {
       np >>= 1;
       height++;
     }
-    pending = new E[n]();
+    pending.assign(n, action.identity());
+    dirty.assign(n, 0);
     tree.resize(2 * n);
-    this->merger = &merger;
     for (I i = n; i < 2 * n; i++) {
       tree[i] = elements[i - n];
     }
     for (I i = n - 1; i > 0; i--) {
-      tree[i] = merger->merge(tree[i << 1], tree[(i << 1) | 1]);
+      tree[i] = this->merger.merge(tree[i << 1], tree[(i << 1) | 1]);
     }
   }
-  ~SegmentTreeLazy() {
-    delete pending;
-    tree.clear();
-  }
-  // this version specifies change of value
-  void modify_node(I i, const E& value, I length) {
-    tree[i] += value * length;
+  ~SegmentTreeLazy() { tree.clear(); }
+  void modify_node(I i, const F& value, I length) {
+    tree[i] = action.apply(value, tree[i], length);
     if (i < n) {
-      pending[i] += value;
+      pending[i] = action.compose(value, pending[i]);
+      dirty[i] = 1;
     }
   }
   // propagate pending changes
@@ -182,27 +552,32 @@ class SegmentTreeLazy {
     I length = ((I)1) << (height - 1);
     for (l += n, r += n - 1; hp > 0; hp--, length >>= 1) {
       for (I i = l >> hp; i <= r >> hp; i++) {
-        if (pending[i] != 0) {
-          modify_node(i << 1, pending[i], length);
-          modify_node((i << 1) | 1, pending[i], length);
-          pending[i] = 0;
-        }
+        push_node(i, length);
       }
     }
   }
+  // hands the pending update of i to its children, each of `length` leaves
+  void push_node(I i, I length) {
+    if (dirty[i]) {
+      modify_node(i << 1, pending[i], length);
+      modify_node((i << 1) | 1, pending[i], length);
+      pending[i] = action.identity();
+      dirty[i] = 0;
+    }
+  }
   void pull(I l, I r) {
     for (l += n, r += n - 1; l > 1;) {
       l >>= 1;
       r >>= 1;
       for (I i = r; i >= l; i--) {
-        if (pending[i] == 0) {
-          tree[i] = merger->merge(tree[i << 1], tree[(i << 1) | 1]);
+        if (!dirty[i]) {
+          tree[i] = merger.merge(tree[i << 1], tree[(i << 1) | 1]);
         }
       }
     }
   }
-  void modify(I l, I r, const E& value) {
-    if (value == 0) return;
+  void modify(I l, I r, const F& value) {
+    if (l >= r) return;
     push(l, l + 1);
     push(r - 1, r);
     I tl = l, tr = r, length = 1;
@@ -214,14 +589,861 @@ class SegmentTreeLazy {
     pull(tr - 1, tr);
   }
   E query(I l, I r) {
+    if (l >= r) return merger.identity();
     push(l, l + 1);
     push(r - 1, r);
-    E resl = merger->identity();
-    E resr = merger->identity();
+    E resl = merger.identity();
+    E resr = merger.identity();
     for (l += n, r += n; l < r; l >>= 1, r >>= 1) {
-      if (l & 1) resl = merger->merge(resl, tree[l++]);
-      if (r & 1) resr = merger->merge(tree[--r], resr);
+      if (l & 1) resl = merger.merge(resl, tree[l++]);
+      if (r & 1) resr = merger.merge(tree[--r], resr);
+    }
+    return merger.merge(resl, resr);
+  }
+  // same as SegmentTree::max_right, pushing pending updates on the way down
+  template <class P>
+  I max_right(I l, P pred) {
+    if (l >= n) return n;
+    push(l, l + 1);
+    push(n - 1, n);
+    I nodes[128], lengths[128];
+    int count = decompose(l, n, nodes, lengths);
+    E acc = merger.identity();
+    for (int k = 0; k < count; k++) {
+      I i = nodes[k], length = lengths[k];
+      E next = merger.merge(acc, tree[i]);
+      if (pred(next)) {
+        acc = next;
+        continue;
+      }
+      for (; i < n; length >>= 1) {
+        push_node(i, length >> 1);
+        i <<= 1;
+        next = merger.merge(acc, tree[i]);
+        if (pred(next)) {
+          acc = next;
+          i++;
+        }
+      }
+      return i - n;
+    }
+    return n;
+  }
+  // same as SegmentTree::min_left, pushing pending updates on the way down
+  template <class P>
+  I min_left(I r, P pred) {
+    if (r <= 0) return 0;
+    push(0, 1);
+    push(r - 1, r);
+    I nodes[128], lengths[128];
+    int count = decompose(0, r, nodes, lengths);
+    E acc = merger.identity();
+    for (int k = count - 1; k >= 0; k--) {
+      I i = nodes[k], length = lengths[k];
+      E next = merger.merge(tree[i], acc);
+      if (pred(next)) {
+        acc = next;
+        continue;
+      }
+      for (; i < n; length >>= 1) {
+        push_node(i, length >> 1);
+        i = (i << 1) | 1;
+        next = merger.merge(tree[i], acc);
+        if (pred(next)) {
+          acc = next;
+          i--;
+        }
+      }
+      return i + 1 - n;
+    }
+    return 0;
+  }
+
+ private:
+  // the nodes query(l, r) merges left to right, with their number of leaves
+  int decompose(I l, I r, I* nodes, I* lengths) const {
+    I right[64], right_lengths[64];
+    int count = 0, count_right = 0;
+    I length = 1;
+    for (l += n, r += n; l < r; l >>= 1, r >>= 1, length <<= 1) {
+      if (l & 1) {
+        lengths[count] = length;
+        nodes[count++] = l++;
+      }
+      if (r & 1) {
+        right_lengths[count_right] = length;
+        right[count_right++] = --r;
+      }
+    }
+    while (count_right > 0) {
+      count_right--;
+      lengths[count] = right_lengths[count_right];
+      nodes[count++] = right[count_right];
+    }
+    return count;
+  }
+};
+
+// "segment tree beats" (Ji Ruyi): range chmin, chmax and add with sum, min
+// and max queries in amortized O(log^2 n). every node keeps the largest
+// and smallest values, how often they occur and the runner-ups, so a
+// chmin that only lowers the maximum of a node is applied to it whole.
+// E is a signed integer type. ranges are left inclusive, right exclusive
+// HDU 5306
+template <class I, class E>
+class SegmentTreeBeats {
+  struct Node {
+    E sum, max1, max2, min1, min2, add;
+    I maxc, minc;
+  };
+  static constexpr E kLow = std::numeric_limits<E>::min();
+  static constexpr E kHigh = std::numeric_limits<E>::max();
+  std::vector<Node> tree;
+  I n;
+
+  void build(const std::vector<E>& elements, I k, I lo, I hi) {
+    if (hi - lo == 1) {
+      E value = elements[lo];
+      tree[k] = Node{value, value, kLow, value, kHigh, 0, 1, 1};
+      return;
+    }
+    I mid = lo + (hi - lo) / 2;
+    build(elements, k << 1, lo, mid);
+    build(elements, (k << 1) | 1, mid, hi);
+    pull(k);
+  }
+  void pull(I k) {
+    Node& x = tree[k];
+    const Node& a = tree[k << 1];
+    const Node& b = tree[(k << 1) | 1];
+    x.sum = a.sum + b.sum;
+    if (a.max1 == b.max1) {
+      x.max1 = a.max1;
+      x.maxc = a.maxc + b.maxc;
+      x.max2 = std::max(a.max2, b.max2);
+    } else {
+      const Node& hi = a.max1 > b.max1 ? a : b;
+      const Node& lo = a.max1 > b.max1 ? b : a;
+      x.max1 = hi.max1;
+      x.maxc = hi.maxc;
+      x.max2 = std::max(hi.max2, lo.max1);
+    }
+    if (a.min1 == b.min1) {
+      x.min1 = a.min1;
+      x.minc = a.minc + b.minc;
+      x.min2 = std::min(a.min2, b.min2);
+    } else {
+      const Node& lo = a.min1 < b.min1 ? a : b;
+      const Node& hi = a.min1 < b.min1 ? b : a;
+      x.min1 = lo.min1;
+      x.minc = lo.minc;
+      x.min2 = std::min(lo.min2, hi.min1);
+    }
+  }
+  void apply_add(I k, E value, I length) {
+    Node& x = tree[k];
+    x.sum += value * length;
+    x.max1 += value;
+    x.min1 += value;
+    if (x.max2 != kLow) x.max2 += value;
+    if (x.min2 != kHigh) x.min2 += value;
+    x.add += value;
+  }
+  // only valid while value > max2
+  void apply_chmin(I k, E value) {
+    Node& x = tree[k];
+    if (x.max1 <= value) return;
+    x.sum -= (x.max1 - value) * x.maxc;
+    if (x.min1 == x.max1) {
+      x.min1 = value;
+    } else if (x.min2 == x.max1) {
+      x.min2 = value;
+    }
+    x.max1 = value;
+  }
+  // only valid while value < min2
+  void apply_chmax(I k, E value) {
+    Node& x = tree[k];
+    if (x.min1 >= value) return;
+    x.sum += (value - x.min1) * x.minc;
+    if (x.max1 == x.min1) {
+      x.max1 = value;
+    } else if (x.max2 == x.min1) {
+      x.max2 = value;
+    }
+    x.min1 = value;
+  }
+  void push(I k, I lo, I hi) {
+    Node& x = tree[k];
+    I mid = lo + (hi - lo) / 2;
+    if (x.add != 0) {
+      apply_add(k << 1, x.add, mid - lo);
+      apply_add((k << 1) | 1, x.add, hi - mid);
+      x.add = 0;
+    }
+    for (I c = k << 1; c <= ((k << 1) | 1); c++) {
+      apply_chmin(c, x.max1);
+      apply_chmax(c, x.min1);
+    }
+  }
+  void chmin(I k, I lo, I hi, I l, I r, E value) {
+    if (r <= lo || hi <= l || tree[k].max1 <= value) return;
+    if (l <= lo && hi <= r && tree[k].max2 < value) {
+      apply_chmin(k, value);
+      return;
+    }
+    push(k, lo, hi);
+    I mid = lo + (hi - lo) / 2;
+    chmin(k << 1, lo, mid, l, r, value);
+    chmin((k << 1) | 1, mid, hi, l, r, value);
+    pull(k);
+  }
+  void chmax(I k, I lo, I hi, I l, I r, E value) {
+    if (r <= lo || hi <= l || tree[k].min1 >= value) return;
+    if (l <= lo && hi <= r && tree[k].min2 > value) {
+      apply_chmax(k, value);
+      return;
+    }
+    push(k, lo, hi);
+    I mid = lo + (hi - lo) / 2;
+    chmax(k << 1, lo, mid, l, r, value);
+    chmax((k << 1) | 1, mid, hi, l, r, value);
+    pull(k);
+  }
+  void add(I k, I lo, I hi, I l, I r, E value) {
+    if (r <= lo || hi <= l) return;
+    if (l <= lo && hi <= r) {
+      apply_add(k, value, hi - lo);
+      return;
+    }
+    push(k, lo, hi);
+    I mid = lo + (hi - lo) / 2;
+    add(k << 1, lo, mid, l, r, value);
+    add((k << 1) | 1, mid, hi, l, r, value);
+    pull(k);
+  }
+  // calls merge on the nodes that make up [l, r)
+  template <class Merge>
+  void query(I k, I lo, I hi, I l, I r, Merge merge) {
+    if (r <= lo || hi <= l) return;
+    if (l <= lo && hi <= r) {
+      merge(tree[k]);
+      return;
+    }
+    push(k, lo, hi);
+    I mid = lo + (hi - lo) / 2;
+    query(k << 1, lo, mid, l, r, merge);
+    query((k << 1) | 1, mid, hi, l, r, merge);
+  }
+
+ public:
+  SegmentTreeBeats() : n(0) {}
+  SegmentTreeBeats(const std::vector<E>& elements) : n(elements.size()) {
+    tree.resize(4 * n);
+    if (n > 0) build(elements, 1, 0, n);
+  }
+  // a[i] = min(a[i], value) for i in [l, r)
+  void chmin(I l, I r, E value) {
+    if (l < r) chmin(1, 0, n, l, r, value);
+  }
+  // a[i] = max(a[i], value) for i in [l, r)
+  void chmax(I l, I r, E value) {
+    if (l < r) chmax(1, 0, n, l, r, value);
+  }
+  void add(I l, I r, E value) {
+    if (l < r) add(1, 0, n, l, r, value);
+  }
+  E query_sum(I l, I r) {
+    E res = 0;
+    query(1, 0, n, l, r, [&](const Node& x) { res += x.sum; });
+    return res;
+  }
+  E query_min(I l, I r) {
+    E res = kHigh;
+    query(1, 0, n, l, r, [&](const Node& x) { res = std::min(res, x.min1); });
+    return res;
+  }
+  E query_max(I l, I r) {
+    E res = kLow;
+    query(1, 0, n, l, r, [&](const Node& x) { res = std::max(res, x.max1); });
+    return res;
+  }
+};
+
+#ifdef SEGMENT_TREE_AVX2
+// merged value of block[a, b) for 64-byte blocks of int or long long, the
+// lanes outside [a, b) are replaced by the identity before reducing
+template <class E, class M>
+inline __attribute__((target("avx2"))) E reduce_block_avx2(const E* block,
+                                                            int a, int b) {
+  const int lanes = 32 / sizeof(E);
+  __m256i x[2];
+  for (int k = 0; k < 2; k++) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)(block + k * lanes));
+    __m256i id, lo, hi, idx;
+    if constexpr (sizeof(E) == 4) {
+      idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+      idx = _mm256_add_epi32(idx, _mm256_set1_epi32(k * lanes));
+      lo = _mm256_cmpgt_epi32(_mm256_set1_epi32(a), idx);
+      hi = _mm256_cmpgt_epi32(_mm256_set1_epi32(b), idx);
+      id = _mm256_set1_epi32((int)M().identity());
+    } else {
+      idx = _mm256_setr_epi64x(0, 1, 2, 3);
+      idx = _mm256_add_epi64(idx, _mm256_set1_epi64x(k * lanes));
+      lo = _mm256_cmpgt_epi64(_mm256_set1_epi64x(a), idx);
+      hi = _mm256_cmpgt_epi64(_mm256_set1_epi64x(b), idx);
+      id = _mm256_set1_epi64x((long long)M().identity());
+    }
+    // keep lanes with a <= idx < b
+    x[k] = _mm256_blendv_epi8(id, v, _mm256_andnot_si256(lo, hi));
+  }
+  __m256i v = x[0], w = x[1];
+  if constexpr (std::is_same<M, MySum<E>>::value) {
+    v = sizeof(E) == 4 ? _mm256_add_epi32(v, w) : _mm256_add_epi64(v, w);
+  } else if constexpr (sizeof(E) == 4) {
+    v = std::is_same<M, MyMin<E>>::value ? _mm256_min_epi32(v, w)
+                                         : _mm256_max_epi32(v, w);
+  } else {
+    __m256i gt = _mm256_cmpgt_epi64(v, w);
+    v = std::is_same<M, MyMin<E>>::value ? _mm256_blendv_epi8(v, w, gt)
+                                         : _mm256_blendv_epi8(w, v, gt);
+  }
+  alignas(32) E out[32 / sizeof(E)];
+  _mm256_store_si256((__m256i*)out, v);
+  M merger;
+  E res = out[0];
+  for (int k = 1; k < lanes; k++) {
+    res = merger.merge(res, out[k]);
+  }
+  return res;
+}
+#endif
+
+// read-only tree for static data. level 0 holds the elements, every level
+// above holds one merged value per 64-byte block of the level below, so a
+// query reads at most two blocks per level and the height is log_B(n)
+// instead of log_2(n). levels are padded with the identity to whole blocks
+// and stored back to back, 64-byte aligned when sizeof(E) divides 64.
+// blocks of int or long long under MySum, MyMin or MyMax are reduced with
+// AVX2 when the cpu has it
+template <class I, class E, class M = DynamicMerger<E>>
+class StaticSegmentTree {
+  static const I B = sizeof(E) > 32 ? 2 : 64 / sizeof(E);
+  std::vector<E> buffer;
+  I base;
+  std::vector<I> offset;
+  M merger;
+  bool simd;
+  I n;
+
+  const E* level(I k) const { return buffer.data() + base + offset[k]; }
+
+  static constexpr bool vectorized =
+      std::is_integral<E>::value && (sizeof(E) == 4 || sizeof(E) == 8) &&
+      (std::is_same<M, MySum<E>>::value || std::is_same<M, MyMin<E>>::value ||
+       std::is_same<M, MyMax<E>>::value);
+
+  // the blocks a query reads only depend on l and r, so all of their
+  // cache misses can be started up front
+  void prefetch(I l, I r) const {
+    if (l >= r) return;
+    for (I k = 0, a = l, b = r - 1; k < (I)offset.size(); k++) {
+      __builtin_prefetch(level(k) + a);
+      __builtin_prefetch(level(k) + b);
+      a /= B;
+      b /= B;
+    }
+  }
+
+  // merged value of data[a, b), both inside the same block
+  E reduce(const E* data, I a, I b) const {
+    E res = merger.identity();
+    for (I i = a; i < b; i++) {
+      res = merger.merge(res, data[i]);
+    }
+    return res;
+  }
+
+#ifdef SEGMENT_TREE_AVX2
+  __attribute__((target("avx2"))) E reduce_avx2(const E* data, I a,
+                                                I b) const {
+    I block = a / B * B;
+    return reduce_block_avx2<E, M>(data + block, a - block, b - block);
+  }
+
+  // same walk as query, compiled for avx2 so the block reductions inline
+  __attribute__((target("avx2"))) E query_avx2(I l, I r) const {
+    prefetch(l, r);
+    E resl = merger.identity();
+    E resr = merger.identity();
+    for (I k = 0; l < r; k++) {
+      const E* data = level(k);
+      I nl = (l + B - 1) / B, nr = r / B;
+      if (nl > nr) {
+        resl = merger.merge(resl, reduce_avx2(data, l, r));
+        break;
+      }
+      if (l < nl * B) {
+        resl = merger.merge(resl, reduce_avx2(data, l, nl * B));
+      }
+      if (nr * B < r) {
+        resr = merger.merge(reduce_avx2(data, nr * B, r), resr);
+      }
+      l = nl;
+      r = nr;
+    }
+    return merger.merge(resl, resr);
+  }
+#endif
+
+ public:
+  StaticSegmentTree() : merger(UnsetMerger<M>::get()) {}
+  StaticSegmentTree(const std::vector<E>& elements, const M& merger = M())
+      : merger(merger), n(elements.size()) {
+#ifdef SEGMENT_TREE_AVX2
+    simd = __builtin_cpu_supports("avx2");
+#else
+    simd = false;
+#endif
+    I total = 0;
+    for (I size = n;; size = (size + B - 1) / B) {
+      offset.push_back(total);
+      total += (size + B - 1) / B * B;
+      if (size <= 1) break;
+    }
+    buffer.assign(total + B, this->merger.identity());
+    base = 0;
+    if (64 % sizeof(E) == 0) {
+      while ((uintptr_t)(buffer.data() + base) % 64) base++;
+    }
+    E* data = buffer.data() + base;
+    std::copy(elements.begin(), elements.end(), data);
+    for (size_t k = 1; k < offset.size(); k++) {
+      const E* below = data + offset[k - 1];
+      for (I i = 0; offset[k - 1] + i * B < offset[k]; i++) {
+        E res = below[i * B];
+        for (I j = 1; j < B; j++) {
+          res = this->merger.merge(res, below[i * B + j]);
+        }
+        data[offset[k] + i] = res;
+      }
+    }
+  }
+  // left inclusive, right exclusive
+  E query(I l, I r) const {
+#ifdef SEGMENT_TREE_AVX2
+    if constexpr (vectorized) {
+      if (simd) return query_avx2(l, r);
+    }
+#endif
+    prefetch(l, r);
+    E resl = merger.identity();
+    E resr = merger.identity();
+    for (I k = 0; l < r; k++) {
+      const E* data = level(k);
+      I nl = (l + B - 1) / B, nr = r / B;
+      if (nl > nr) {
+        resl = merger.merge(resl, reduce(data, l, r));
+        break;
+      }
+      if (l < nl * B) resl = merger.merge(resl, reduce(data, l, nl * B));
+      if (nr * B < r) resr = merger.merge(reduce(data, nr * B, r), resr);
+      l = nl;
+      r = nr;
+    }
+    return merger.merge(resl, resr);
+  }
+};
+
+// bump allocator for tree nodes addressed by 32-bit indices instead of
+// pointers. nodes live in chunks that never move, so a reference stays
+// valid while the pool grows. index 0 is allocated first and meant as the
+// shared null node
+template <class Node>
+class NodePool {
+  static const int kShift = 16;
+  static const uint32_t kMask = (1u << kShift) - 1;
+  std::vector<std::unique_ptr<Node[]>> chunks;
+  uint32_t count;
+
+ public:
+  NodePool() : count(0) {}
+  // node indices are 32 bits, past 2^32 - 1 nodes they would wrap around
+  // and alias the first ones
+  uint32_t allocate() {
+    if (count == std::numeric_limits<uint32_t>::max()) {
+      throw std::length_error("NodePool: more than 2^32 - 1 nodes");
+    }
+    if ((count & kMask) == 0) {
+      chunks.emplace_back(new Node[kMask + 1]);
+    }
+    return count++;
+  }
+  Node& operator[](uint32_t i) { return chunks[i >> kShift][i & kMask]; }
+  const Node& operator[](uint32_t i) const {
+    return chunks[i >> kShift][i & kMask];
+  }
+  uint32_t size() const { return count; }
+  size_t bytes() const { return chunks.size() * (kMask + 1) * sizeof(Node); }
+};
+
+// every modify creates a new version sharing all but O(log n) nodes with
+// the version it was made from, and every version stays queryable.
+// version 0 is the initial array. subtrees of identities are the null
+// node, so the (n) constructor takes O(1) memory
+// SPOJ MKTHNUM
+template <class I, class E, class M = DynamicMerger<E>>
+class PersistentSegmentTree {
+  struct Node {
+    E value;
+    uint32_t left, right;
+  };
+  NodePool<Node> pool;
+  std::vector<uint32_t> roots;
+  M merger;
+  I n;
+
+  uint32_t build(const std::vector<E>& elements, I lo, I hi) {
+    uint32_t node = pool.allocate();
+    if (hi - lo == 1) {
+      pool[node] = Node{elements[lo], 0, 0};
+      return node;
+    }
+    I mid = lo + (hi - lo) / 2;
+    uint32_t left = build(elements, lo, mid);
+    uint32_t right = build(elements, mid, hi);
+    pool[node] =
+        Node{merger.merge(pool[left].value, pool[right].value), left, right};
+    return node;
+  }
+  uint32_t modify(uint32_t from, I lo, I hi, I i, const E& value) {
+    uint32_t node = pool.allocate();
+    if (hi - lo == 1) {
+      pool[node] = Node{value, 0, 0};
+      return node;
+    }
+    I mid = lo + (hi - lo) / 2;
+    uint32_t left = pool[from].left, right = pool[from].right;
+    if (i < mid) {
+      left = modify(left, lo, mid, i, value);
+    } else {
+      right = modify(right, mid, hi, i, value);
+    }
+    pool[node] =
+        Node{merger.merge(pool[left].value, pool[right].value), left, right};
+    return node;
+  }
+  E query(uint32_t node, I lo, I hi, I l, I r) const {
+    if (node == 0 || (l <= lo && hi <= r)) return pool[node].value;
+    I mid = lo + (hi - lo) / 2;
+    if (r <= mid) return query(pool[node].left, lo, mid, l, r);
+    if (l >= mid) return query(pool[node].right, mid, hi, l, r);
+    return merger.merge(query(pool[node].left, lo, mid, l, r),
+                        query(pool[node].right, mid, hi, l, r));
+  }
+
+ public:
+  PersistentSegmentTree(I n = 0, const M& merger = M())
+      : merger(merger), n(n) {
+    pool.allocate();
+    pool[0] = Node{this->merger.identity(), 0, 0};
+    roots.push_back(0);
+  }
+  PersistentSegmentTree(const std::vector<E>& elements, const M& merger = M())
+      : PersistentSegmentTree(elements.size(), merger) {
+    if (n > 0) roots[0] = build(elements, 0, n);
+  }
+  // sets element i of `version` and returns the number of the new version
+  size_t modify(size_t version, I i, const E& value) {
+    roots.push_back(modify(roots[version], 0, n, i, value));
+    return roots.size() - 1;
+  }
+  // left inclusive, right exclusive
+  E query(size_t version, I l, I r) const {
+    if (l >= r) return merger.identity();
+    return query(roots[version], 0, n, l, r);
+  }
+  // smallest i such that the sum of [0, i] in version `to` minus the same
+  // sum in version `from` exceeds k, i.e. the k-th (from 0) position of a
+  // multiset difference of counts. M must be MySum, or another merger with
+  // an inverse. k must be below the total difference
+  I kth(size_t from, size_t to, E k) const {
+    uint32_t a = roots[from], b = roots[to];
+    I lo = 0, hi = n;
+    while (hi - lo > 1) {
+      I mid = lo + (hi - lo) / 2;
+      E left = pool[pool[b].left].value - pool[pool[a].left].value;
+      if (k < left) {
+        a = pool[a].left;
+        b = pool[b].left;
+        hi = mid;
+      } else {
+        k -= left;
+        a = pool[a].right;
+        b = pool[b].right;
+        lo = mid;
+      }
+    }
+    return lo;
+  }
+  size_t versions() const { return roots.size(); }
+  // memory held by the node pool
+  size_t bytes() const { return pool.bytes(); }
+};
+
+// segment tree over the keys [0, size) that only creates the nodes on the
+// paths it touches, so keys need no compression and memory grows with the
+// number of operations instead of size. untouched keys hold E(), which must
+// also be the merged value of any run of them (true for MySum, MyMin and
+// MyMax). ranges are left inclusive, right exclusive and take the same
+// actions as SegmentTreeLazy. keys at or past size are rejected with
+// std::out_of_range
+template <class E, class M = MySum<E>, class A = AddSum<E>>
+class SparseSegmentTree {
+  typedef typename A::F F;
+  struct Node {
+    E value;
+    F pending;
+    uint32_t left, right;
+    bool dirty;
+  };
+  NodePool<Node> pool;
+  M merger;
+  A action;
+  uint64_t n;
+  uint32_t root;
+
+  uint32_t create() {
+    uint32_t node = pool.allocate();
+    pool[node] = Node{E(), action.identity(), 0, 0, false};
+    return node;
+  }
+  // the left or right child of node, created on first use
+  uint32_t child(uint32_t node, bool right) {
+    uint32_t& c = right ? pool[node].right : pool[node].left;
+    if (c == 0) c = create();
+    return c;
+  }
+  void apply(uint32_t node, const F& f, uint64_t length) {
+    Node& x = pool[node];
+    x.value = action.apply(f, x.value, length);
+    if (length > 1) {
+      x.pending = action.compose(f, x.pending);
+      x.dirty = true;
+    }
+  }
+  void push(uint32_t node, uint64_t lo, uint64_t hi) {
+    if (!pool[node].dirty) return;
+    uint64_t mid = lo + (hi - lo) / 2;
+    uint32_t left = child(node, false), right = child(node, true);
+    Node& x = pool[node];
+    apply(left, x.pending, mid - lo);
+    apply(right, x.pending, hi - mid);
+    x.pending = action.identity();
+    x.dirty = false;
+  }
+  // r is the end of a nonempty range, or a key plus one
+  void check(uint64_t r) const {
+    if (r > n || r == 0) {
+      throw std::out_of_range("SparseSegmentTree: key past size");
+    }
+  }
+  // a missing child reads as the null node 0, which holds E()
+  void pull(uint32_t node) {
+    Node& x = pool[node];
+    x.value = merger.merge(pool[x.left].value, pool[x.right].value);
+  }
+  void modify(uint32_t node, uint64_t lo, uint64_t hi, uint64_t i,
+              const E& value) {
+    if (hi - lo == 1) {
+      pool[node].value = value;
+      return;
+    }
+    push(node, lo, hi);
+    uint64_t mid = lo + (hi - lo) / 2;
+    if (i < mid) {
+      modify(child(node, false), lo, mid, i, value);
+    } else {
+      modify(child(node, true), mid, hi, i, value);
+    }
+    pull(node);
+  }
+  void modify(uint32_t node, uint64_t lo, uint64_t hi, uint64_t l, uint64_t r,
+              const F& f) {
+    if (l <= lo && hi <= r) {
+      apply(node, f, hi - lo);
+      return;
+    }
+    push(node, lo, hi);
+    uint64_t mid = lo + (hi - lo) / 2;
+    if (l < mid) modify(child(node, false), lo, mid, l, r, f);
+    if (r > mid) modify(child(node, true), mid, hi, l, r, f);
+    pull(node);
+  }
+  E query(uint32_t node, uint64_t lo, uint64_t hi, uint64_t l, uint64_t r) {
+    // an untouched subtree
+    if (node == 0) return E();
+    if (l <= lo && hi <= r) return pool[node].value;
+    push(node, lo, hi);
+    uint64_t mid = lo + (hi - lo) / 2;
+    if (r <= mid) return query(pool[node].left, lo, mid, l, r);
+    if (l >= mid) return query(pool[node].right, mid, hi, l, r);
+    return merger.merge(query(pool[node].left, lo, mid, l, r),
+                        query(pool[node].right, mid, hi, l, r));
+  }
+
+ public:
+  SparseSegmentTree(uint64_t size = 1ull << 63, const M& merger = M(),
+                    const A& action = A())
+      : merger(merger), action(action), n(size) {
+    create();
+    root = create();
+  }
+  void modify(uint64_t i, const E& value) {
+    check(i + 1);
+    modify(root, 0, n, i, value);
+  }
+  void modify(uint64_t l, uint64_t r, const F& f) {
+    if (l >= r) return;
+    check(r);
+    modify(root, 0, n, l, r, f);
+  }
+  E query(uint64_t l, uint64_t r) {
+    if (l >= r) return merger.identity();
+    check(r);
+    return query(root, 0, n, l, r);
+  }
+  uint32_t nodes() const { return pool.size() - 1; }
+  // memory held by the node pool
+  size_t bytes() const { return pool.bytes(); }
+};
+
+// SegmentTree shared by threads. queries never lock: they read the nodes
+// with relaxed atomic loads under seqlocks and retry if a write overlapped
+// them. the leaves are split into up to kBlocks blocks with a sequence each,
+// and a query only checks the blocks its range overlaps. the nodes it reads
+// cover leaves of its range only, and a write only touches ancestors of the
+// leaves it sets, so a query never retries for a write outside its range.
+// writers serialize on a mutex, and modify_batch publishes a whole batch at
+// once, so a query sees either all or none of it. the ancestors to merge are
+// collected before the write starts to keep readers waiting as little as
+// possible. E must be trivially copyable, ideally lock-free as an atomic
+// (int, long long, double)
+template <class I, class E, class M = DynamicMerger<E>>
+class ConcurrentSegmentTree {
+  static_assert(std::is_trivially_copyable<E>::value,
+                "elements are read and written as std::atomic<E>");
+  static const I kBlocks = 64;
+  // odd while a write to the block is in progress. one per cache line, so
+  // a write does not evict the sequences of other blocks from readers
+  struct alignas(64) Sequence {
+    std::atomic<uint64_t> value{0};
+  };
+  std::unique_ptr<std::atomic<E>[]> tree;
+  std::unique_ptr<Sequence[]> sequence;
+  std::mutex writer;
+  M merger;
+  I n, block;
+
+  E get(I i) const { return tree[i].load(std::memory_order_relaxed); }
+  void set(I i, const E& value) {
+    tree[i].store(value, std::memory_order_relaxed);
+  }
+  // bumps the sequences of the blocks in [first, last)
+  void bump(const I* first, const I* last, std::memory_order order) {
+    for (const I* b = first; b != last; b++) {
+      std::atomic<uint64_t>& value = sequence[*b].value;
+      value.store(value.load(std::memory_order_relaxed) + 1, order);
+    }
+  }
+  void begin_write(const I* first, const I* last) {
+    bump(first, last, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  void end_write(const I* first, const I* last) {
+    bump(first, last, std::memory_order_release);
+  }
+  // true if a write to the blocks of [l, r) is in progress or happened
+  // since `before` was read
+  bool changed(I l, I r, const uint64_t* before) const {
+    for (I b = l / block; b <= (r - 1) / block; b++) {
+      if (sequence[b].value.load(std::memory_order_relaxed) !=
+          before[b - l / block]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ public:
+  ConcurrentSegmentTree(const std::vector<E>& elements, const M& merger = M())
+      : tree(new std::atomic<E>[2 * elements.size()]),
+        sequence(new Sequence[kBlocks]),
+        merger(merger),
+        n(elements.size()),
+        block(std::max<I>(1, (n + kBlocks - 1) / kBlocks)) {
+    for (I i = n; i < 2 * n; i++) {
+      set(i, elements[i - n]);
+    }
+    for (I i = n - 1; i > 0; i--) {
+      set(i, this->merger.merge(get(i << 1), get((i << 1) | 1)));
+    }
+  }
+  void modify(I i, const E& value) {
+    I b = i / block;
+    std::lock_guard<std::mutex> lock(writer);
+    begin_write(&b, &b + 1);
+    for (set(i += n, value); i >>= 1;) {
+      set(i, merger.merge(get(i << 1), get((i << 1) | 1)));
+    }
+    end_write(&b, &b + 1);
+  }
+  // same result as SegmentTree::modify_batch, published in one write
+  void modify_batch(const std::vector<std::pair<I, E>>& updates) {
+    std::vector<std::vector<I>> depth = dirty_ancestors(updates, n);
+    std::vector<I> blocks;
+    for (auto& update : updates) {
+      blocks.push_back(update.first / block);
+    }
+    std::sort(blocks.begin(), blocks.end());
+    blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+    const I* first = blocks.data();
+    const I* last = first + blocks.size();
+    std::lock_guard<std::mutex> lock(writer);
+    begin_write(first, last);
+    for (auto& update : updates) {
+      set(update.first + n, update.second);
+    }
+    for (size_t d = depth.size(); d-- > 0;) {
+      for (I i : depth[d]) {
+        set(i, merger.merge(get(i << 1), get((i << 1) | 1)));
+      }
+    }
+    end_write(first, last);
+  }
+  // left inclusive, right exclusive
+  E query(I l, I r) const {
+    if (l >= r) return merger.identity();
+    uint64_t before[kBlocks];
+    for (;;) {
+      bool writing = false;
+      for (I b = l / block; b <= (r - 1) / block; b++) {
+        before[b - l / block] =
+            sequence[b].value.load(std::memory_order_acquire);
+        writing |= before[b - l / block] & 1;
+      }
+      if (writing) {
+        std::this_thread::yield();
+        continue;
+      }
+      E resl = merger.identity();
+      E resr = merger.identity();
+      for (I a = l + n, b = r + n; a < b; a >>= 1, b >>= 1) {
+        if (a & 1) resl = merger.merge(resl, get(a++));
+        if (b & 1) resr = merger.merge(get(--b), resr);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (!changed(l, r, before)) return merger.merge(resl, resr);
     }
-    return merger->merge(resl, resr);
   }
 };
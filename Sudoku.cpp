@@ -5,9 +5,43 @@ using namespace std;
 
 namespace sudoku {
 
+// build with -DSUDOKU_STATS to count search events. without it the hooks
+// expand to nothing and neither solvers nor reports carry any counters
+#ifdef SUDOKU_STATS
+#define SUDOKU_STAT(x) x
+#else
+#define SUDOKU_STAT(x)
+#endif
+
+struct Stats {
+  // nodes: empty cells branched on, backtracks: placements undone,
+  // propagations: row/col/reg mask updates, max_depth: longest chain of
+  // placements on the search path
+  long long nodes = 0, backtracks = 0, propagations = 0;
+  int depth = 0, max_depth = 0;
+  void Place() {
+    propagations++;
+    max_depth = max(max_depth, ++depth);
+  }
+  void Undo() {
+    backtracks++;
+    propagations++;
+    depth--;
+  }
+  void Merge(const Stats& other) {
+    nodes += other.nodes;
+    backtracks += other.backtracks;
+    propagations += other.propagations;
+    max_depth = max(max_depth, other.max_depth);
+  }
+};
+
 class SudokuSolver {
  public:
   char board[81];
+#ifdef SUDOKU_STATS
+  Stats stats;
+#endif
   virtual void Init() = 0;
   virtual void Set(const char board[81]) = 0;
   virtual bool HasUniqueSolution() = 0;
@@ -67,6 +101,123 @@ class SudokuSolver {
   }
 };
 
+// fixed set of workers, each owning a deque of tasks. owners push and pop
+// at the back, idle workers steal from the front of the other deques, so
+// stolen tasks tend to be the large subtrees near the root
+template <class Task>
+class WorkStealingPool {
+ public:
+  typedef function<void(WorkStealingPool&, int, Task&)> Handler;
+
+  WorkStealingPool(int threads, Handler handler)
+      : queues(threads), locks(threads), handler(handler) {
+    for (int w = 0; w < threads; w++) {
+      workers.emplace_back(&WorkStealingPool::Work, this, w);
+    }
+  }
+
+  ~WorkStealingPool() {
+    {
+      lock_guard<mutex> guard(idle_lock);
+      stop = true;
+    }
+    idle.notify_all();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+  int Size() const { return queues.size(); }
+
+  // may be called from a handler to split its task further
+  void Push(int worker, const Task& task) {
+    pending++;
+    {
+      lock_guard<mutex> guard(locks[worker]);
+      queues[worker].push_back(task);
+    }
+    queued++;
+    {
+      lock_guard<mutex> guard(idle_lock);
+    }
+    idle.notify_one();
+  }
+
+  // blocks until every pushed task, including the ones pushed by handlers,
+  // has been processed
+  void Wait() {
+    unique_lock<mutex> guard(idle_lock);
+    done.wait(guard, [this] { return pending == 0; });
+  }
+
+ private:
+  vector<deque<Task>> queues;
+  vector<mutex> locks;
+  vector<thread> workers;
+  Handler handler;
+  // pending: pushed and not finished yet, queued: pushed and not taken yet
+  atomic<long long> pending{0}, queued{0};
+  bool stop = false;
+  mutex idle_lock;
+  condition_variable idle, done;
+
+  bool Pop(int w, Task& task) {
+    lock_guard<mutex> guard(locks[w]);
+    if (queues[w].empty()) {
+      return false;
+    }
+    task = queues[w].back();
+    queues[w].pop_back();
+    queued--;
+    return true;
+  }
+
+  bool Steal(int w, Task& task) {
+    for (int k = 1; k < Size(); k++) {
+      int victim = (w + k) % Size();
+      lock_guard<mutex> guard(locks[victim]);
+      if (!queues[victim].empty()) {
+        task = queues[victim].front();
+        queues[victim].pop_front();
+        queued--;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Work(int w) {
+    Task task;
+    while (true) {
+      if (Pop(w, task) || Steal(w, task)) {
+        handler(*this, w, task);
+        if (--pending == 0) {
+          lock_guard<mutex> guard(idle_lock);
+          done.notify_all();
+          idle.notify_all();
+        }
+      } else {
+        // sleep while the running tasks may still push more
+        unique_lock<mutex> guard(idle_lock);
+        idle.wait(guard,
+                  [this] { return queued > 0 || (stop && pending == 0); });
+        if (queued == 0) {
+          return;
+        }
+      }
+    }
+  }
+};
+
+// board and masks of a BacktrackingSolver, enough to resume a search at
+// cell i on another solver
+struct BacktrackingState {
+  char board[81];
+  int row[9], col[9], reg[9];
+  char i;
+  char depth;
+};
+
 struct BacktrackingSolver : public SudokuSolver {
   const int candidate_mask = ((1 << 10) - 1) - 1;
   char row_index[81];
@@ -87,6 +238,7 @@ struct BacktrackingSolver : public SudokuSolver {
   }
 
   void Set(const char other[81]) override {
+    SUDOKU_STAT(stats = Stats());
     memcpy(board, other, 81 * sizeof(char));
     memset(row, 0xff, sizeof(row));
     memset(col, 0xff, sizeof(col));
@@ -109,12 +261,132 @@ struct BacktrackingSolver : public SudokuSolver {
     }
   }
 
+  void Save(BacktrackingState& state, char i, char depth) const {
+    memcpy(state.board, board, sizeof(state.board));
+    memcpy(state.row, row, sizeof(row));
+    memcpy(state.col, col, sizeof(col));
+    memcpy(state.reg, reg, sizeof(reg));
+    state.i = i;
+    state.depth = depth;
+  }
+
+  void Load(const BacktrackingState& state) {
+    memcpy(board, state.board, sizeof(board));
+    memcpy(row, state.row, sizeof(row));
+    memcpy(col, state.col, sizeof(col));
+    memcpy(reg, state.reg, sizeof(reg));
+  }
+
+  // edits a single clue, keeping the masks in sync without a full Set
+  void Place(char i, char value) {
+    int bit = 1 << value;
+    board[i] = value;
+    row[row_index[i]] ^= bit;
+    col[col_index[i]] ^= bit;
+    reg[reg_index[i]] ^= bit;
+  }
+
+  void Remove(char i) {
+    int bit = 1 << board[i];
+    row[row_index[i]] |= bit;
+    col[col_index[i]] |= bit;
+    reg[reg_index[i]] |= bit;
+    board[i] = 0;
+  }
+
+  // counts solutions until limit is reached, branching on the empty cell
+  // with the fewest candidates. unlike dfs, board and masks are always
+  // restored, so the solver can be reused for the next check
+  long long CountUpTo(long long limit) {
+    char best = -1;
+    int best_count = 10, best_candidates = 0;
+    for (char i = 0; i < 81 && best_count > 1; i++) {
+      if (board[i] == 0) {
+        int candidates = row[row_index[i]] & col[col_index[i]] &
+                         reg[reg_index[i]] & candidate_mask;
+        int count = __builtin_popcount(candidates);
+        if (count < best_count) {
+          best = i;
+          best_count = count;
+          best_candidates = candidates;
+        }
+      }
+    }
+    if (best == -1) {
+      return 1;
+    }
+    SUDOKU_STAT(stats.nodes++);
+    long long ct = 0;
+    while (best_candidates && ct < limit) {
+      int bit = best_candidates & (~(best_candidates - 1));
+      best_candidates &= (best_candidates - 1);
+      Place(best, num[bit]);
+      SUDOKU_STAT(stats.Place());
+      ct += CountUpTo(limit - ct);
+      Remove(best);
+      SUDOKU_STAT(stats.Undo());
+    }
+    return ct;
+  }
+
+  // same count as dfs(0, true, true). the first split_depth empty cells are
+  // expanded into one task per candidate, deeper subtrees are counted
+  // sequentially on a private copy of the solver
+  long long ParallelCount(int threads = 0, int split_depth = 4) {
+    if (threads <= 0) {
+      threads = max(1u, thread::hardware_concurrency());
+    }
+    vector<BacktrackingSolver> solvers(threads, *this);
+    SUDOKU_STAT(for (auto& solver : solvers) solver.stats = Stats());
+    atomic<long long> total(0);
+    WorkStealingPool<BacktrackingState> pool(
+        threads, [&](WorkStealingPool<BacktrackingState>& tasks, int w,
+                     BacktrackingState& task) {
+          BacktrackingSolver& solver = solvers[w];
+          solver.Load(task);
+          SUDOKU_STAT(solver.stats.depth = task.depth);
+          char i = task.i;
+          while (i < 81 && solver.board[i] != 0) {
+            i++;
+          }
+          if (i == 81) {
+            total += 1;
+          } else if (task.depth >= split_depth) {
+            total += solver.dfs(i, true, true);
+          } else {
+            int candidates = solver.row[row_index[i]] &
+                             solver.col[col_index[i]] &
+                             solver.reg[reg_index[i]] & candidate_mask;
+            SUDOKU_STAT(solver.stats.nodes++);
+            BacktrackingState child;
+            while (candidates) {
+              int bit = candidates & (~(candidates - 1));
+              candidates &= (candidates - 1);
+              solver.board[i] = num[bit];
+              solver.row[row_index[i]] ^= bit;
+              solver.col[col_index[i]] ^= bit;
+              solver.reg[reg_index[i]] ^= bit;
+              solver.Save(child, i + 1, task.depth + 1);
+              tasks.Push(w, child);
+              solver.Load(task);
+            }
+          }
+        });
+    BacktrackingState root;
+    Save(root, 0, 0);
+    pool.Push(0, root);
+    pool.Wait();
+    SUDOKU_STAT(for (auto& solver : solvers) stats.Merge(solver.stats));
+    return total;
+  }
+
   long long dfs(char i, bool countMode = false, bool exploreAll = false) {
     long long ct = 0;
     if (i == 81) {
       return 1;
     }
     if (board[i] == 0) {
+      SUDOKU_STAT(stats.nodes++);
       int candidates = row[row_index[i]] & col[col_index[i]] &
                        reg[reg_index[i]] & candidate_mask;
       while (candidates) {
@@ -124,6 +396,7 @@ struct BacktrackingSolver : public SudokuSolver {
         row[row_index[i]] ^= bit;
         col[col_index[i]] ^= bit;
         reg[reg_index[i]] ^= bit;
+        SUDOKU_STAT(stats.Place());
         if (countMode) {
           ct += dfs(i + 1, countMode, exploreAll);
           if (ct > 1 && !exploreAll) {
@@ -138,6 +411,7 @@ struct BacktrackingSolver : public SudokuSolver {
         col[col_index[i]] |= bit;
         row[row_index[i]] |= bit;
         board[i] = 0;
+        SUDOKU_STAT(stats.Undo());
       }
     } else {
       return dfs(i + 1, countMode, exploreAll);
@@ -222,6 +496,7 @@ struct HeapSolver : public SudokuSolver {
   }
 
   void Set(const char other[81]) override {
+    SUDOKU_STAT(stats = Stats());
     eyes.reserve(81);
     memcpy(board, other, 81 * sizeof(char));
     metadata = MetaData();
@@ -264,6 +539,7 @@ struct HeapSolver : public SudokuSolver {
       return 1;
     }
     if (board[i] == 0) {
+      SUDOKU_STAT(stats.nodes++);
       int candidates = metadata.GetCandidates(i);
       bool popped = false;
       if (eyes.size()) {
@@ -276,6 +552,7 @@ struct HeapSolver : public SudokuSolver {
         candidates &= (candidates - 1);
         board[i] = metadata.num[bit];
         metadata.UnsetMask(i, bit);
+        SUDOKU_STAT(stats.Place());
         if (countMode) {
           ct += dfs(nextI(), countMode, exploreAll);
           if (ct > 1 && !exploreAll) {
@@ -288,6 +565,7 @@ struct HeapSolver : public SudokuSolver {
         }
         metadata.SetMask(i, bit);
         board[i] = 0;
+        SUDOKU_STAT(stats.Undo());
       }
       if (popped) {
         eyes.push_back(PriorityIndex(i, metadata));
@@ -305,4 +583,433 @@ bool PriorityIndex::operator<(const PriorityIndex& other) const {
          __builtin_popcount(metadata.GetCandidates(other.index));
 }
 
+// board plus the free digits of every row, column and region. a branch
+// copies the whole snapshot instead of undoing its placements
+struct Snapshot {
+  char board[81];
+  char empty;
+  unsigned short row[9], col[9], reg[9];
+};
+
+// depth first search over an explicit stack of snapshots. every frame
+// fills all forced cells (naked and hidden singles) before branching on the
+// cell with the fewest candidates, so at most 81 frames are ever live
+struct IterativeSolver : public SudokuSolver {
+  const int candidate_mask = ((1 << 10) - 1) - 1;
+  char row_index[81];
+  char col_index[81];
+  char reg_index[81];
+  char units[27][9];
+  char num[513];
+  struct Frame {
+    Snapshot state;
+    char cell;
+    int candidates;
+  } stack[82];
+  Snapshot root;
+
+  void Init() override {
+    for (char i = 1; i <= 9; i++) {
+      num[1 << i] = i;
+    }
+    for (char i = 0; i < 81; i++) {
+      row_index[i] = i / 9;
+      col_index[i] = i % 9;
+      reg_index[i] = row_index[i] / 3 * 3 + col_index[i] / 3;
+    }
+    int size[27] = {};
+    for (char i = 0; i < 81; i++) {
+      units[row_index[i]][size[row_index[i]]++] = i;
+      units[9 + col_index[i]][size[9 + col_index[i]]++] = i;
+      units[18 + reg_index[i]][size[18 + reg_index[i]]++] = i;
+    }
+  }
+
+  void Set(const char other[81]) override {
+    SUDOKU_STAT(stats = Stats());
+    memcpy(board, other, 81 * sizeof(char));
+    memcpy(root.board, other, 81 * sizeof(char));
+    root.empty = 81;
+    for (int k = 0; k < 9; k++) {
+      root.row[k] = root.col[k] = root.reg[k] = candidate_mask;
+    }
+    for (int i = 0; i < 81; i++) {
+      if (board[i] != 0) {
+        Place(root, i, board[i]);
+      }
+    }
+  }
+
+  bool HasUniqueSolution() override { return CountUpTo(2) == 1; }
+
+  char* SolveOne() override {
+    if (CountUpTo(1)) {
+      return board;
+    } else {
+      return nullptr;
+    }
+  }
+
+  int Candidates(const Snapshot& s, char i) const {
+    return s.row[row_index[i]] & s.col[col_index[i]] & s.reg[reg_index[i]];
+  }
+
+  void Place(Snapshot& s, char i, char value) {
+    int bit = 1 << value;
+    s.board[i] = value;
+    s.row[row_index[i]] ^= bit;
+    s.col[col_index[i]] ^= bit;
+    s.reg[reg_index[i]] ^= bit;
+    s.empty--;
+  }
+
+  // places every digit that fits only one cell of a unit. returns -1 on a
+  // contradiction, otherwise the number of cells placed
+  int HiddenSingles(Snapshot& s) {
+    int placed = 0;
+    for (int u = 0; u < 27; u++) {
+      int once = 0, twice = 0, filled = 0;
+      for (char i : units[u]) {
+        if (s.board[i] != 0) {
+          filled |= 1 << s.board[i];
+        } else {
+          int c = Candidates(s, i);
+          twice |= once & c;
+          once |= c;
+        }
+      }
+      if ((once | filled) != candidate_mask) {
+        return -1;
+      }
+      for (int single = once & ~twice; single; single &= single - 1) {
+        int bit = single & (~(single - 1));
+        for (char i : units[u]) {
+          if (s.board[i] == 0 && (Candidates(s, i) & bit)) {
+            Place(s, i, num[bit]);
+            SUDOKU_STAT(stats.propagations++);
+            placed++;
+            break;
+          }
+        }
+      }
+    }
+    return placed;
+  }
+
+  // fills forced cells until none are left. returns false on a
+  // contradiction, otherwise the cell to branch on, -1 once solved
+  bool Propagate(Snapshot& s, char& cell, int& candidates) {
+    bool forced = true;
+    while (forced) {
+      forced = false;
+      cell = -1;
+      int best_count = 10;
+      for (char i = 0; i < 81; i++) {
+        if (s.board[i] != 0) {
+          continue;
+        }
+        int c = Candidates(s, i);
+        int count = __builtin_popcount(c);
+        if (count == 0) {
+          return false;
+        } else if (count == 1) {
+          Place(s, i, num[c]);
+          SUDOKU_STAT(stats.propagations++);
+          forced = true;
+        } else if (!forced && count < best_count) {
+          cell = i;
+          best_count = count;
+          candidates = c;
+        }
+      }
+      if (!forced && cell != -1) {
+        int placed = HiddenSingles(s);
+        if (placed < 0) {
+          return false;
+        }
+        forced = placed > 0;
+      }
+    }
+    SUDOKU_STAT(stats.max_depth =
+                    max(stats.max_depth, (int)(root.empty - s.empty)));
+    return true;
+  }
+
+  // counts solutions until limit is reached, the first one is copied into
+  // board
+  long long CountUpTo(long long limit) {
+    long long ct = 0;
+    int depth = 0;
+    stack[0].state = root;
+    if (!Propagate(stack[0].state, stack[0].cell, stack[0].candidates)) {
+      return 0;
+    }
+    if (stack[0].cell == -1) {
+      memcpy(board, stack[0].state.board, sizeof(board));
+      return 1;
+    }
+    SUDOKU_STAT(stats.nodes++);
+    while (depth >= 0) {
+      Frame* top = stack + depth;
+      if (top->candidates == 0) {
+        SUDOKU_STAT(stats.backtracks++);
+        depth--;
+        continue;
+      }
+      int bit = top->candidates & (~(top->candidates - 1));
+      top->candidates &= (top->candidates - 1);
+      Frame* next = top + 1;
+      next->state = top->state;
+      Place(next->state, top->cell, num[bit]);
+      SUDOKU_STAT(stats.propagations++);
+      if (!Propagate(next->state, next->cell, next->candidates)) {
+        continue;
+      }
+      if (next->cell == -1) {
+        if (ct++ == 0) {
+          memcpy(board, next->state.board, sizeof(board));
+        }
+        if (ct >= limit) {
+          break;
+        }
+        continue;
+      }
+      SUDOKU_STAT(stats.nodes++);
+      depth++;
+    }
+    return ct;
+  }
+};
+
+// reads 81 digits, '0' or '.' for empty cells
+void Parse(const string& s, char grid[81]) {
+  for (int i = 0; i < 81; i++) {
+    grid[i] = (s[i] == '.') ? 0 : s[i] - '0';
+  }
+}
+
+// per-puzzle latencies of a batch run, in input order. the summaries of an
+// empty batch are 0
+struct BatchReport {
+  vector<double> latency;  // microseconds
+#ifdef SUDOKU_STATS
+  vector<Stats> stats;
+#endif
+
+  double Percentile(double p) const {
+    if (latency.empty()) return 0;
+    vector<double> sorted(latency);
+    size_t k = min(sorted.size() - 1, (size_t)(p * sorted.size()));
+    nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k];
+  }
+
+  double Max() const {
+    return latency.empty() ? 0 : *max_element(latency.begin(), latency.end());
+  }
+
+  vector<size_t> Slowest(size_t k) const {
+    vector<size_t> order(latency.size());
+    iota(order.begin(), order.end(), 0);
+    k = min(k, order.size());
+    partial_sort(order.begin(), order.begin() + k, order.end(),
+                 [this](size_t a, size_t b) { return latency[a] > latency[b]; });
+    order.resize(k);
+    return order;
+  }
+
+  // bucket b counts latencies in [2^b, 2^(b+1)) microseconds
+  vector<int> Histogram() const {
+    vector<int> buckets;
+    for (double t : latency) {
+      size_t b = t < 1 ? 0 : (size_t)log2(t);
+      if (b >= buckets.size()) {
+        buckets.resize(b + 1);
+      }
+      buckets[b]++;
+    }
+    return buckets;
+  }
+
+  void Print(ostream& out, const vector<string>& puzzles,
+             size_t slowest = 5) const {
+    out << "p50 " << Percentile(0.5) << "us, p99 " << Percentile(0.99)
+        << "us, max " << Max() << "us\n";
+    vector<int> buckets = Histogram();
+    for (size_t b = 0; b < buckets.size(); b++) {
+      if (buckets[b]) {
+        out << "  < " << (1ll << (b + 1)) << "us: " << buckets[b] << '\n';
+      }
+    }
+    for (size_t k : Slowest(slowest)) {
+      out << "  " << puzzles[k] << ' ' << latency[k] << "us";
+#ifdef SUDOKU_STATS
+      out << ", nodes " << stats[k].nodes << ", backtracks "
+          << stats[k].backtracks << ", propagations " << stats[k].propagations
+          << ", max depth " << stats[k].max_depth;
+#endif
+      out << '\n';
+    }
+  }
+};
+
+// solves every puzzle with SolveOne, timing Set plus the search
+BatchReport RunBatch(SudokuSolver& solver, const vector<string>& puzzles) {
+  BatchReport report;
+  char grid[81];
+  for (auto& puzzle : puzzles) {
+    Parse(puzzle, grid);
+    auto start = chrono::steady_clock::now();
+    solver.Set(grid);
+    solver.SolveOne();
+    auto end = chrono::steady_clock::now();
+    report.latency.push_back(
+        chrono::duration<double, micro>(end - start).count());
+    SUDOKU_STAT(report.stats.push_back(solver.stats));
+  }
+  return report;
+}
+
+// generates minimal puzzles by removing clues from a random solution.
+// removing clue i with value v keeps the solution unique iff no solution
+// puts another value at i, so each check stops at the first alternative.
+// a clue that cannot be removed stays necessary once more clues are gone,
+// so every cell is checked at most once and the result is minimal.
+// up to `threads` cells are checked speculatively against the same puzzle,
+// then the first removable one is taken and the other removable ones are
+// checked again against the smaller puzzle
+class Generator {
+ public:
+  long long checks = 0;
+
+  Generator(int threads = 1, unsigned seed = 5489u)
+      : rng(seed), solvers(max(threads, 1)), synced(solvers.size()) {
+    for (auto& solver : solvers) {
+      solver.Init();
+    }
+    if (threads > 1) {
+      pool.reset(new WorkStealingPool<int>(
+          threads, [this](WorkStealingPool<int>&, int w, int& k) {
+            removable[k] = Removable(w, batch[k]);
+          }));
+    }
+  }
+
+  // returns a minimal puzzle with at most target clues, drawing up to
+  // `attempts` random solutions, or "" if none of them got that low. no
+  // puzzle has fewer than 17 clues, so lower targets fail at once, and
+  // minimal puzzles below about 21 clues are rare
+  string Generate(int target = 81, int attempts = 100000) {
+    if (target < 17) return "";
+    for (int k = 0; k < attempts; k++) {
+      Minimize();
+      if (Clues() <= target) {
+        string s;
+        for (int i = 0; i < 81; i++) {
+          s += (char)(puzzle[i] + '0');
+        }
+        return s;
+      }
+    }
+    return "";
+  }
+
+ private:
+  mt19937 rng;
+  vector<BacktrackingSolver> solvers;
+  vector<size_t> synced;
+  unique_ptr<WorkStealingPool<int>> pool;
+  char solution[81], puzzle[81];
+  vector<char> removed;
+  vector<char> batch, removable;
+
+  int Clues() const { return 81 - removed.size(); }
+
+  void RandomSolution() {
+    // the diagonal boxes do not constrain each other
+    char grid[81] = {};
+    char digits[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    for (int k = 0; k < 3; k++) {
+      shuffle(digits, digits + 9, rng);
+      for (int j = 0; j < 9; j++) {
+        grid[(k * 3 + j / 3) * 9 + k * 3 + j % 3] = digits[j];
+      }
+    }
+    BacktrackingSolver& solver = solvers[0];
+    solver.Set(grid);
+    memcpy(solution, solver.SolveOne(), sizeof(solution));
+  }
+
+  // replays the removals the worker's solver has not seen yet
+  void Sync(int w) {
+    for (; synced[w] < removed.size(); synced[w]++) {
+      solvers[w].Remove(removed[synced[w]]);
+    }
+  }
+
+  bool Removable(int w, char i) {
+    Sync(w);
+    BacktrackingSolver& solver = solvers[w];
+    char value = solver.board[i];
+    solver.Remove(i);
+    int candidates = solver.row[solver.row_index[i]] &
+                     solver.col[solver.col_index[i]] &
+                     solver.reg[solver.reg_index[i]] & solver.candidate_mask &
+                     ~(1 << value);
+    bool unique = true;
+    while (candidates && unique) {
+      int bit = candidates & (~(candidates - 1));
+      candidates &= (candidates - 1);
+      solver.Place(i, solver.num[bit]);
+      unique = solver.CountUpTo(1) == 0;
+      solver.Remove(i);
+    }
+    solver.Place(i, value);
+    return unique;
+  }
+
+  void Minimize() {
+    RandomSolution();
+    memcpy(puzzle, solution, sizeof(puzzle));
+    removed.clear();
+    for (size_t w = 0; w < solvers.size(); w++) {
+      solvers[w].Set(puzzle);
+      synced[w] = 0;
+    }
+    deque<char> order(81);
+    iota(order.begin(), order.end(), 0);
+    shuffle(order.begin(), order.end(), rng);
+    while (!order.empty()) {
+      batch.clear();
+      while (!order.empty() && batch.size() < solvers.size()) {
+        batch.push_back(order.front());
+        order.pop_front();
+      }
+      removable.assign(batch.size(), false);
+      if (pool) {
+        for (size_t k = 0; k < batch.size(); k++) {
+          pool->Push(k, k);
+        }
+        pool->Wait();
+      } else {
+        removable[0] = Removable(0, batch[0]);
+      }
+      checks += batch.size();
+      size_t first = 0;
+      while (first < batch.size() && !removable[first]) {
+        first++;
+      }
+      if (first < batch.size()) {
+        puzzle[batch[first]] = 0;
+        removed.push_back(batch[first]);
+        for (size_t k = batch.size() - 1; k > first; k--) {
+          if (removable[k]) {
+            order.push_front(batch[k]);
+          }
+        }
+      }
+    }
+  }
+};
+
 }  // namespace sudoku
@@ -1,69 +1,407 @@
-#include <bits/stdc++.h>
-using namespace std;
-
-typedef long long ll;
-const int MAX = (1 << 23);
-ll bit[MAX + 1];
-
-// 1 indexed for both modify and query
-ll query(ll x) {
-  ll res = 0;
-  while (x > 0) {
-    res += bit[x];
-    x -= x & -x;
-  }
-  return res;
-}
-
-void modify(ll x, ll val) {
-  while (x <= MAX) {
-    bit[x] += val;
-    x += x & -x;
-  }
-}
-
-const char* test_data = R"__(
-10 4
-+ 7 23
-? 8
-+ 3 17
-? 8
-)__";
-
-const char* test_out = R"__(23
-40
-)__";
-
-int main() {
-  ios::sync_with_stdio(0);
-  cin.tie(0);
-
-  stringstream s_in(test_data);
-  stringstream s_out;
-
-  string op;
-  ll n, q;
-  ll x, delta;
-  s_in >> n >> q;
-  for (int i = 0; i < q; i++) {
-    s_in >> op;
-    if (op[0] == '+') {
-      s_in >> x >> delta;
-      x++;
-      modify(x, delta);
-    } else {
-      s_in >> x;
-      if (x == 0) {
-        s_out << 0 << '\n';
+// included by other library files too
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// binary indexed tree over n elements sized at runtime. the public
+// interface is 0 indexed like SegmentTree, ranges are left inclusive,
+// right exclusive. bit is 1 indexed inside
+template <class T>
+class Fenwick {
+  std::vector<T> bit;
+  int n;
+
+ public:
+  Fenwick(int n = 0) : bit(n + 1), n(n) {}
+  // O(n): every node passes its partial sum on to its parent once
+  Fenwick(const std::vector<T>& elements) : bit(elements.size() + 1) {
+    n = elements.size();
+    for (int x = 1; x <= n; x++) {
+      bit[x] += elements[x - 1];
+      int parent = x + (x & -x);
+      if (parent <= n) bit[parent] += bit[x];
+    }
+  }
+  // a[i] += delta
+  void modify(int i, const T& delta) {
+    for (int x = i + 1; x <= n; x += x & -x) {
+      bit[x] += delta;
+    }
+  }
+  // sum of [0, r)
+  T query(int r) const {
+    T res = T();
+    for (int x = r; x > 0; x -= x & -x) {
+      res += bit[x];
+    }
+    return res;
+  }
+  // sum of [l, r)
+  T query(int l, int r) const { return query(r) - query(l); }
+  // smallest i such that the sum of [0, i] is at least k, n if there is
+  // none. elements must be non-negative. descends the implicit tree by
+  // powers of two, so it takes O(log n) instead of binary searching query
+  int lower_bound(T k) const {
+    int pos = 0;
+    int step = n > 0 ? 1 << (31 - __builtin_clz(n)) : 0;
+    for (; step > 0; step >>= 1) {
+      if (pos + step <= n && bit[pos + step] < k) {
+        pos += step;
+        k -= bit[pos];
+      }
+    }
+    return pos;
+  }
+  // all elements back to T(), keeping the storage when n fits in it
+  void reset() { std::fill(bit.begin(), bit.end(), T()); }
+  void reset(int size) {
+    n = size;
+    bit.assign(n + 1, T());
+  }
+  int size() const { return n; }
+};
+
+// Fenwick with the same interface for trees of millions of entries. in
+// the plain layout every step of query and modify past the first few
+// lands on a different cache line and, at 4 KB pages, on a different
+// page. here the elements are kept as they are in blocks of kBlock and
+// the Fenwick tree only runs over the block sums, so it is kBlock times
+// smaller and log2(kBlock) levels shorter, and the tail of a query is a
+// scan inside one block. all of it lives in one 2 MB aligned allocation
+// advised to be backed by huge pages
+template <class T>
+class LargeFenwick {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "the storage is raw memory");
+  static const int kBlock = 16;
+  static const size_t kPage = 1 << 21;
+  static const size_t kLine = 64;
+  struct Free {
+    void operator()(T* p) const { std::free(p); }
+  };
+  // n elements rounded up to whole blocks, then the 1 indexed tree over
+  // the m block sums
+  std::unique_ptr<T[], Free> storage;
+  size_t capacity;
+  T* elements;
+  T* bit;
+  int n, m;
+
+  void allocate(int size) {
+    n = size;
+    m = (n + kBlock - 1) / kBlock;
+    size_t count = (size_t)m * kBlock + m + 1;
+    size_t bytes = count * sizeof(T);
+    if (bytes > capacity) {
+      // below a huge page it only needs to start on a cache line
+      size_t align = bytes < kPage ? kLine : kPage;
+      capacity = (bytes + align - 1) / align * align;
+      storage.reset((T*)std::aligned_alloc(align, capacity));
+      if (!storage) {
+        capacity = 0;
+        throw std::bad_alloc();
+      }
+#ifdef MADV_HUGEPAGE
+      if (align == kPage) madvise(storage.get(), capacity, MADV_HUGEPAGE);
+#endif
+    }
+    elements = storage.get();
+    bit = elements + (size_t)m * kBlock;
+    std::fill(storage.get(), storage.get() + count, T());
+  }
+
+ public:
+  LargeFenwick(int n = 0) : capacity(0) { allocate(n); }
+  LargeFenwick(const std::vector<T>& values) : capacity(0) {
+    allocate(values.size());
+    std::copy(values.begin(), values.end(), elements);
+    for (int x = 1; x <= m; x++) {
+      for (int i = (x - 1) * kBlock; i < x * kBlock; i++) {
+        bit[x] += elements[i];
+      }
+      int parent = x + (x & -x);
+      if (parent <= m) bit[parent] += bit[x];
+    }
+  }
+  // a[i] += delta
+  void modify(int i, const T& delta) {
+    elements[i] += delta;
+    for (int x = i / kBlock + 1; x <= m; x += x & -x) {
+      bit[x] += delta;
+    }
+  }
+  // sum of [0, r)
+  T query(int r) const {
+    T res = T();
+    for (int x = r / kBlock; x > 0; x -= x & -x) {
+      res += bit[x];
+    }
+    for (int i = r / kBlock * kBlock; i < r; i++) {
+      res += elements[i];
+    }
+    return res;
+  }
+  // sum of [l, r)
+  T query(int l, int r) const { return query(r) - query(l); }
+  // same as Fenwick::lower_bound, the descent picks the block and a scan
+  // the element inside it
+  int lower_bound(T k) const {
+    int pos = 0;
+    int step = m > 0 ? 1 << (31 - __builtin_clz(m)) : 0;
+    for (; step > 0; step >>= 1) {
+      if (pos + step <= m && bit[pos + step] < k) {
+        pos += step;
+        k -= bit[pos];
+      }
+    }
+    int i = pos * kBlock;
+    for (; i < n && elements[i] < k; i++) {
+      k -= elements[i];
+    }
+    return std::min(i, n);
+  }
+  void reset() { allocate(n); }
+  void reset(int size) { allocate(size); }
+  int size() const { return n; }
+};
+
+// Fenwick shared by threads without locks: modify adds to the nodes with
+// relaxed atomic adds and query reads them with relaxed loads. a query
+// is not a snapshot, but every node only ever grows when the deltas are
+// non-negative, so a query that starts after another finished never
+// returns less. T must be an integer type
+template <class T>
+class ConcurrentFenwick {
+  std::unique_ptr<std::atomic<T>[]> bit;
+  int n;
+
+ public:
+  ConcurrentFenwick(int n = 0) : bit(new std::atomic<T>[n + 1]), n(n) {
+    for (int x = 0; x <= n; x++) {
+      bit[x].store(0, std::memory_order_relaxed);
+    }
+  }
+  // a[i] += delta
+  void modify(int i, T delta) {
+    for (int x = i + 1; x <= n; x += x & -x) {
+      bit[x].fetch_add(delta, std::memory_order_relaxed);
+    }
+  }
+  // sum of [0, r)
+  T query(int r) const {
+    T res = 0;
+    for (int x = r; x > 0; x -= x & -x) {
+      res += bit[x].load(std::memory_order_relaxed);
+    }
+    return res;
+  }
+  // sum of [l, r)
+  T query(int l, int r) const { return query(r) - query(l); }
+  int size() const { return n; }
+
+  // per-thread buffer of deltas merged into the shared tree lazily, when
+  // it fills up, on flush and on destruction. deltas to the same index
+  // are added up first, so hot counters cost one walk per flush. queries
+  // don't see what is still buffered
+  class Writer {
+    ConcurrentFenwick& fenwick;
+    std::vector<std::pair<int, T>> buffer;
+    size_t capacity;
+
+   public:
+    Writer(ConcurrentFenwick& fenwick, size_t capacity = 1024)
+        : fenwick(fenwick), capacity(capacity) {
+      buffer.reserve(capacity);
+    }
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    ~Writer() { flush(); }
+    void modify(int i, T delta) {
+      buffer.emplace_back(i, delta);
+      if (buffer.size() >= capacity) flush();
+    }
+    void flush() {
+      std::sort(buffer.begin(), buffer.end(),
+                [](const std::pair<int, T>& a, const std::pair<int, T>& b) {
+                  return a.first < b.first;
+                });
+      for (size_t k = 0; k < buffer.size();) {
+        int i = buffer[k].first;
+        T delta = 0;
+        for (; k < buffer.size() && buffer[k].first == i; k++) {
+          delta += buffer[k].second;
+        }
+        if (delta != 0) fenwick.modify(i, delta);
+      }
+      buffer.clear();
+    }
+  };
+};
+
+// range add and range sum with two trees: after adding v to [l, r) the sum
+// of [0, p) is p * slope.query(p) - offset.query(p)
+template <class T>
+class RangeFenwick {
+  Fenwick<T> slope, offset;
+
+ public:
+  RangeFenwick(int n = 0) : slope(n), offset(n) {}
+  RangeFenwick(const std::vector<T>& elements) : slope(elements.size()) {
+    std::vector<T> negated(elements.size());
+    for (size_t i = 0; i < elements.size(); i++) {
+      negated[i] = -elements[i];
+    }
+    offset = Fenwick<T>(negated);
+  }
+  // a[i] += value for i in [l, r)
+  void modify(int l, int r, const T& value) {
+    slope.modify(l, value);
+    slope.modify(r, -value);
+    offset.modify(l, value * l);
+    offset.modify(r, -value * r);
+  }
+  // sum of [0, r)
+  T query(int r) const { return slope.query(r) * r - offset.query(r); }
+  // sum of [l, r)
+  T query(int l, int r) const { return query(r) - query(l); }
+  void reset() {
+    slope.reset();
+    offset.reset();
+  }
+  int size() const { return slope.size(); }
+};
+
+// Fenwick tree over a D dimensional grid in one flat vector, 1 indexed
+// inside with stride[d] between neighbours along dimension d. queries take
+// boxes, left inclusive, right exclusive in every dimension
+template <class T, int D>
+class FenwickND {
+  typedef std::array<int, D> Index;
+  std::vector<T> bit;
+  Index n;
+  std::array<size_t, D> stride;
+
+  template <int d>
+  void modify(size_t offset, const Index& i, const T& delta) {
+    for (int x = i[d] + 1; x <= n[d]; x += x & -x) {
+      if constexpr (d + 1 == D) {
+        bit[offset + x] += delta;
+      } else {
+        modify<d + 1>(offset + x * stride[d], i, delta);
+      }
+    }
+  }
+  template <int d>
+  T query(size_t offset, const Index& r) const {
+    T res = T();
+    for (int x = r[d]; x > 0; x -= x & -x) {
+      if constexpr (d + 1 == D) {
+        res += bit[offset + x];
+      } else {
+        res += query<d + 1>(offset + x * stride[d], r);
+      }
+    }
+    return res;
+  }
+
+ public:
+  FenwickND() {
+    n.fill(0);
+    stride.fill(0);
+  }
+  FenwickND(const Index& n) : n(n) {
+    size_t size = 1;
+    for (int d = D - 1; d >= 0; d--) {
+      stride[d] = size;
+      size *= n[d] + 1;
+    }
+    bit.assign(size, T());
+  }
+  // a[i] += delta
+  void modify(const Index& i, const T& delta) { modify<0>(0, i, delta); }
+  // sum of the box [0, r)
+  T query(const Index& r) const { return query<0>(0, r); }
+  // sum of the box [l, r), by inclusion-exclusion over its 2^D corners
+  T query(const Index& l, const Index& r) const {
+    T res = T();
+    for (int mask = 0; mask < (1 << D); mask++) {
+      Index corner;
+      int sign = 1;
+      for (int d = 0; d < D; d++) {
+        if (l[d] >= r[d]) return T();
+        corner[d] = mask >> d & 1 ? l[d] : r[d];
+        if (mask >> d & 1) sign = -sign;
+      }
+      if (sign > 0) {
+        res += query(corner);
       } else {
-        ll ans = query(x);
-        s_out << ans << '\n';
+        res -= query(corner);
       }
     }
+    return res;
   }
-  assert(strcmp(s_out.str().c_str(), test_out) == 0);
-  return 0;
-}
+  void reset() { std::fill(bit.begin(), bit.end(), T()); }
+  const Index& size() const { return n; }
+};
 
-// kattis:
-// fenwick: use fast io!!
+// 2D range add and range sum. the 1D trick of RangeFenwick in both
+// dimensions needs four sums per cell, kept side by side in one FenwickND
+// so an update walks the grid once per corner: after adding v to the
+// rectangle starting at (x, y) the sum of [0, X) x [0, Y) is
+// X * Y * a - Y * b - X * c + d with a = v, b = v * x, c = v * y and
+// d = v * x * y
+template <class T>
+class RangeFenwick2D {
+  struct Cell {
+    T a, b, c, d;
+    Cell() : a(), b(), c(), d() {}
+    Cell& operator+=(const Cell& other) {
+      a += other.a;
+      b += other.b;
+      c += other.c;
+      d += other.d;
+      return *this;
+    }
+  };
+  FenwickND<Cell, 2> fenwick;
+
+  void modify_corner(int x, int y, const T& value) {
+    Cell cell;
+    cell.a = value;
+    cell.b = value * x;
+    cell.c = value * y;
+    cell.d = value * x * y;
+    fenwick.modify({x, y}, cell);
+  }
+
+ public:
+  RangeFenwick2D(int n = 0, int m = 0) : fenwick({n, m}) {}
+  // a[x][y] += value for x in [x1, x2) and y in [y1, y2)
+  void modify(int x1, int y1, int x2, int y2, const T& value) {
+    if (x1 >= x2 || y1 >= y2) return;
+    modify_corner(x1, y1, value);
+    modify_corner(x1, y2, -value);
+    modify_corner(x2, y1, -value);
+    modify_corner(x2, y2, value);
+  }
+  // sum of [0, x) x [0, y)
+  T query(int x, int y) const {
+    Cell cell = fenwick.query({x, y});
+    return cell.a * x * y - cell.b * y - cell.c * x + cell.d;
+  }
+  // sum of [x1, x2) x [y1, y2)
+  T query(int x1, int y1, int x2, int y2) const {
+    if (x1 >= x2 || y1 >= y2) return T();
+    return query(x2, y2) - query(x1, y2) - query(x2, y1) + query(x1, y1);
+  }
+  void reset() { fenwick.reset(); }
+};
@@ -0,0 +1,527 @@
+#include <bits/stdc++.h>
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include "FenwickCommands.cpp"
+#include "IO.cpp"
+#include "fenwick.cpp"
+#include "Timing.cpp"
+using namespace std;
+
+// kattis fenwick sample
+const char* fenwick_data = R"__(
+10 4
++ 7 23
+? 8
++ 3 17
+? 8
+)__";
+
+const char* fenwick_out = R"__(23
+40
+)__";
+
+void testFenwickKattis() {
+  stringstream s_in(fenwick_data);
+  stringstream s_out;
+  string op;
+  int n, q, x;
+  long long delta;
+  s_in >> n >> q;
+  Fenwick<long long> fenwick(n);
+  for (int i = 0; i < q; i++) {
+    s_in >> op;
+    if (op[0] == '+') {
+      s_in >> x >> delta;
+      fenwick.modify(x, delta);
+    } else {
+      s_in >> x;
+      s_out << fenwick.query(x) << '\n';
+    }
+  }
+  assert(s_out.str() == fenwick_out);
+}
+
+void testFenwickLowerBound() {
+  mt19937 rng(43);
+  for (int n : {1, 2, 3, 7, 8, 9, 100, 1000}) {
+    vector<int> counts(n);
+    Fenwick<int> fenwick(n);
+    for (int k = 0; k < 1000; k++) {
+      int i = rng() % n, delta = rng() % 3;
+      counts[i] += delta;
+      fenwick.modify(i, delta);
+      int total = fenwick.query(n);
+      int target = rng() % (total + 2);
+      int expected = 0;
+      for (int sum = counts[0]; expected < n && sum < target;) {
+        if (++expected < n) sum += counts[expected];
+      }
+      assert(fenwick.lower_bound(target) == expected);
+    }
+  }
+}
+
+void testRangeFenwick() {
+  mt19937 rng(44);
+  for (int n : {1, 2, 3, 8, 100, 1000}) {
+    vector<long long> elements(n);
+    for (auto& e : elements) {
+      e = (long long)(rng() % 2001) - 1000;
+    }
+    RangeFenwick<long long> fenwick(elements);
+    for (int k = 0; k < 2000; k++) {
+      int l = rng() % (n + 1), r = rng() % (n + 1);
+      if (l > r) swap(l, r);
+      if (k % 2) {
+        long long value = (long long)(rng() % 201) - 100;
+        fenwick.modify(l, r, value);
+        for (int i = l; i < r; i++) elements[i] += value;
+      }
+      assert(fenwick.query(l, r) ==
+             accumulate(elements.begin() + l, elements.begin() + r, 0ll));
+    }
+  }
+}
+
+void testFenwickND() {
+  mt19937 rng(45);
+  for (auto size : vector<pair<int, int>>{{1, 1}, {1, 9}, {5, 3}, {33, 17}}) {
+    int n = size.first, m = size.second;
+    vector<vector<long long>> grid(n, vector<long long>(m));
+    FenwickND<long long, 2> fenwick({n, m});
+    RangeFenwick2D<long long> range(n, m);
+    for (int k = 0; k < 2000; k++) {
+      int x1 = rng() % (n + 1), x2 = rng() % (n + 1);
+      int y1 = rng() % (m + 1), y2 = rng() % (m + 1);
+      if (x1 > x2) swap(x1, x2);
+      if (y1 > y2) swap(y1, y2);
+      long long value = (long long)(rng() % 201) - 100;
+      if (k % 3 == 0 && x1 < n && y1 < m) {
+        grid[x1][y1] += value;
+        fenwick.modify({x1, y1}, value);
+        range.modify(x1, y1, x1 + 1, y1 + 1, value);
+      } else if (k % 3 == 1) {
+        for (int x = x1; x < x2; x++) {
+          for (int y = y1; y < y2; y++) {
+            grid[x][y] += value;
+            fenwick.modify({x, y}, value);
+          }
+        }
+        range.modify(x1, y1, x2, y2, value);
+      } else {
+        long long expected = 0;
+        for (int x = x1; x < x2; x++) {
+          for (int y = y1; y < y2; y++) {
+            expected += grid[x][y];
+          }
+        }
+        assert(fenwick.query({x1, y1}, {x2, y2}) == expected);
+        assert(range.query(x1, y1, x2, y2) == expected);
+      }
+    }
+  }
+  // 3D voxels
+  const int n = 6, m = 5, h = 7;
+  vector<int> voxels(n * m * h);
+  FenwickND<int, 3> fenwick({n, m, h});
+  for (int k = 0; k < 3000; k++) {
+    int x = rng() % n, y = rng() % m, z = rng() % h, value = rng() % 10;
+    voxels[(x * m + y) * h + z] += value;
+    fenwick.modify({x, y, z}, value);
+    array<int, 3> l = {(int)(rng() % n), (int)(rng() % m), (int)(rng() % h)};
+    array<int, 3> r = {(int)(rng() % (n + 1)), (int)(rng() % (m + 1)),
+                       (int)(rng() % (h + 1))};
+    int expected = 0;
+    for (x = l[0]; x < r[0]; x++) {
+      for (y = l[1]; y < r[1]; y++) {
+        for (z = l[2]; z < r[2]; z++) {
+          expected += voxels[(x * m + y) * h + z];
+        }
+      }
+    }
+    assert(fenwick.query(l, r) == expected);
+  }
+}
+
+void testLargeFenwick() {
+  mt19937 rng(46);
+  for (int n : {1, 2, 15, 16, 17, 100, 1000, 4099}) {
+    vector<int> elements(n);
+    for (auto& e : elements) {
+      e = rng() % 10;
+    }
+    Fenwick<int> expected(elements);
+    LargeFenwick<int> built(elements), added(n);
+    for (int i = 0; i < n; i++) {
+      added.modify(i, elements[i]);
+    }
+    for (int k = 0; k < 2000; k++) {
+      int l = rng() % (n + 1), r = rng() % (n + 1);
+      if (l > r) swap(l, r);
+      if (k % 2) {
+        int delta = rng() % 10;
+        expected.modify(l % n, delta);
+        built.modify(l % n, delta);
+        added.modify(l % n, delta);
+      }
+      assert(built.query(l, r) == expected.query(l, r));
+      assert(added.query(r) == expected.query(r));
+      int target = rng() % (expected.query(n) + 2);
+      assert(built.lower_bound(target) == expected.lower_bound(target));
+    }
+    built.reset(n / 2);
+    assert(built.size() == n / 2 && built.query(n / 2) == 0);
+  }
+  // empty, then grown from a small allocation past a huge page
+  LargeFenwick<int> grown;
+  assert(grown.size() == 0 && grown.query(0) == 0);
+  assert(grown.lower_bound(1) == 0);
+  const int large = 1 << 20;
+  grown.reset(large);
+  grown.modify(large - 1, 5);
+  assert(grown.query(large) == 5 && grown.lower_bound(5) == large - 1);
+}
+
+void testConcurrentFenwick() {
+  const int n = 1000, threads = 4, updates = 20000;
+  ConcurrentFenwick<long long> fenwick(n);
+  atomic<bool> done(false);
+  thread reader([&] {
+    long long last = 0;
+    while (!done) {
+      long long total = fenwick.query(n);
+      assert(total >= last);
+      last = total;
+    }
+  });
+  vector<thread> writers;
+  for (int t = 0; t < threads; t++) {
+    writers.emplace_back([&, t] {
+      mt19937 rng(t);
+      ConcurrentFenwick<long long>::Writer writer(fenwick, 64);
+      for (int k = 0; k < updates; k++) {
+        int i = rng() % n;
+        if (t % 2) {
+          writer.modify(i, i % 7);
+        } else {
+          fenwick.modify(i, i % 7);
+        }
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  done = true;
+  reader.join();
+  Fenwick<long long> expected(n);
+  for (int t = 0; t < threads; t++) {
+    mt19937 rng(t);
+    for (int k = 0; k < updates; k++) {
+      int i = rng() % n;
+      expected.modify(i, i % 7);
+    }
+  }
+  for (int r = 0; r <= n; r++) {
+    assert(fenwick.query(r) == expected.query(r));
+  }
+}
+
+// runs run_fenwick_commands on input and returns what it wrote. rejected,
+// if given, is set when the input names an index outside the tree
+string run_fenwick_stream(const string& input, bool* rejected = nullptr) {
+  FILE* in = tmpfile();
+  FILE* out = tmpfile();
+  fputs(input.c_str(), in);
+  rewind(in);
+  io::set_input(in);
+  io::set_output(out);
+  try {
+    run_fenwick_commands();
+    if (rejected) *rejected = false;
+  } catch (const out_of_range&) {
+    assert(rejected);
+    *rejected = true;
+  }
+  io::set_output(stdout);
+  io::set_input(stdin);
+  rewind(out);
+  string written;
+  for (int c; (c = fgetc(out)) != EOF;) {
+    written += c;
+  }
+  fclose(in);
+  fclose(out);
+  return written;
+}
+
+void testFenwickStream() {
+  assert(run_fenwick_stream(fenwick_data) == fenwick_out);
+  mt19937 rng(47);
+  const int n = 1000, q = 100000;
+  string input = to_string(n) + " " + to_string(q) + "\n", expected;
+  Fenwick<long long> fenwick(n);
+  for (int k = 0; k < q; k++) {
+    int i = rng() % (n + 1);
+    if (k % 2) {
+      long long delta = (long long)(rng() % 2000001) - 1000000;
+      fenwick.modify(i % n, delta);
+      input += "+ " + to_string(i % n) + " " + to_string(delta) + "\n";
+    } else {
+      input += "? " + to_string(i) + (k % 3 ? "\n" : "\n\n  ");
+      expected += to_string(fenwick.query(i)) + "\n";
+    }
+  }
+  assert(run_fenwick_stream(input) == expected);
+  // fewer commands than announced, with and without a trailing newline
+  assert(run_fenwick_stream("10 5\n+ 1 2\n? 3\n") == "2\n");
+  assert(run_fenwick_stream("10 5\n+ 1 2\n? 3") == "2\n");
+  assert(run_fenwick_stream("10 5\n") == "");
+  assert(run_fenwick_stream("") == "");
+  // indices outside the tree, including one that would wrap to 1 as an int
+  bool rejected;
+  assert(run_fenwick_stream("10 2\n? 10\n+ 9 1\n", &rejected) == "0\n");
+  assert(!rejected);
+  for (string bad : {"+ 10 1", "? 11", "+ -1 5", "? -1", "+ 4294967297 5"}) {
+    string written = run_fenwick_stream("10 2\n? 3\n" + bad + "\n", &rejected);
+    assert(rejected && written == "0\n");
+  }
+}
+
+void testFenwick() {
+  testFenwickKattis();
+  testFenwickStream();
+  testConcurrentFenwick();
+  testLargeFenwick();
+  testFenwickLowerBound();
+  testRangeFenwick();
+  testFenwickND();
+  mt19937 rng(42);
+  for (int n : {1, 2, 3, 8, 100, 1000}) {
+    vector<long long> elements(n);
+    for (auto& e : elements) {
+      e = (long long)(rng() % 2001) - 1000;
+    }
+    Fenwick<long long> built(elements), added(n);
+    for (int i = 0; i < n; i++) {
+      added.modify(i, elements[i]);
+    }
+    for (int k = 0; k < 2000; k++) {
+      int l = rng() % (n + 1), r = rng() % (n + 1);
+      if (l > r) swap(l, r);
+      if (k % 2) {
+        long long delta = (long long)(rng() % 2001) - 1000;
+        elements[l % n] += delta;
+        built.modify(l % n, delta);
+        added.modify(l % n, delta);
+      }
+      long long expected =
+          accumulate(elements.begin() + l, elements.begin() + r, 0ll);
+      assert(built.query(l, r) == expected);
+      assert(added.query(l, r) == expected);
+      assert(built.query(r) == accumulate(elements.begin(),
+                                          elements.begin() + r, 0ll));
+    }
+    built.reset();
+    assert(built.size() == n && built.query(n) == 0);
+    built.reset(n / 2);
+    assert(built.size() == n / 2 && built.query(n / 2) == 0);
+  }
+}
+
+// running median of a stream of values in [0, n)
+void benchmarkFenwickLowerBound() {
+  const int n = 1 << 20, ops = 4000000;
+  cout << "running median over " << n << " values, " << ops << " inserts\n";
+  for (int descent = 0; descent < 2; descent++) {
+    Fenwick<int> counts(n);
+    mt19937 rng(ops);
+    long long checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (int k = 0; k < ops; k++) {
+      counts.modify(rng() % n, 1);
+      int target = k / 2 + 1;
+      if (descent) {
+        checksum += counts.lower_bound(target);
+        continue;
+      }
+      int lo = 0, hi = n;
+      while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (counts.query(mid + 1) >= target) {
+          hi = mid;
+        } else {
+          lo = mid + 1;
+        }
+      }
+      checksum += lo;
+    }
+    cout << (descent ? "  lower_bound: " : "  binary search over query: ")
+         << seconds_since(start) << "s, checksum " << checksum
+         << '\n';
+  }
+}
+
+template <class Tree>
+double benchmark_fenwick_mixed(int n, long long ops) {
+  Tree fenwick(n);
+  mt19937 rng(n);
+  long long checksum = 0;
+  auto start = chrono::steady_clock::now();
+  for (long long k = 0; k < ops; k++) {
+    int i = rng() & (n - 1);
+    if (k & 1) {
+      fenwick.modify(i, k);
+    } else {
+      checksum += fenwick.query(i);
+    }
+  }
+  double elapsed = seconds_since(start);
+  if (checksum == 42) cout << '\n';
+  return elapsed;
+}
+
+void benchmarkLargeFenwick() {
+  const long long ops = 100000000;
+  for (int n : {1 << 16, 1 << 20, 1 << 23, 1 << 26}) {
+    cout << "n = " << n << ", " << ops << " mixed query/modify\n";
+    cout << "  Fenwick: " << benchmark_fenwick_mixed<Fenwick<long long>>(n, ops)
+         << "s\n";
+    cout << "  LargeFenwick: "
+         << benchmark_fenwick_mixed<LargeFenwick<long long>>(n, ops) << "s\n";
+  }
+}
+
+// updates per second from `threads` threads, each making `updates`
+// increments through update(thread, rng)
+template <class Update>
+double fenwick_throughput(int threads, int updates, Update update) {
+  auto start = chrono::steady_clock::now();
+  vector<thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] { update(t, updates); });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return (double)threads * updates / seconds_since(start);
+}
+
+void benchmarkConcurrentFenwick() {
+  const int n = 1 << 20, updates = 200000;
+  // a skewed stream, half the increments hit 64 hot counters
+  auto key = [](mt19937& rng, int k) {
+    return k % 2 ? rng() & 63 : rng() & (n - 1);
+  };
+  cout << "n = " << n << ", " << updates << " increments per thread, "
+       << thread::hardware_concurrency() << " hardware threads, updates/s\n";
+  for (int threads = 1; threads <= 64; threads <<= 1) {
+    Fenwick<long long> locked(n);
+    mutex global;
+    double mutexed = fenwick_throughput(threads, updates, [&](int t, int ct) {
+      mt19937 rng(t);
+      for (int k = 0; k < ct; k++) {
+        lock_guard<mutex> lock(global);
+        locked.modify(key(rng, k), 1);
+      }
+    });
+    ConcurrentFenwick<long long> shared(n);
+    double adds = fenwick_throughput(threads, updates, [&](int t, int ct) {
+      mt19937 rng(t);
+      for (int k = 0; k < ct; k++) {
+        shared.modify(key(rng, k), 1);
+      }
+    });
+    ConcurrentFenwick<long long> buffered(n);
+    double writers = fenwick_throughput(threads, updates, [&](int t, int ct) {
+      mt19937 rng(t);
+      ConcurrentFenwick<long long>::Writer writer(buffered);
+      for (int k = 0; k < ct; k++) {
+        writer.modify(key(rng, k), 1);
+      }
+    });
+    assert(shared.query(n) == (long long)threads * updates);
+    assert(buffered.query(n) == (long long)threads * updates);
+    cout << "  " << threads << " threads, mutex: " << mutexed
+         << ", atomic adds: " << adds
+         << ", buffered writers: " << writers << '\n';
+  }
+}
+
+// a generated input of 10^8 commands on disk, read once with
+// run_fenwick_commands and once with istream >>
+void benchmarkFenwickStream() {
+  const int n = 1000000;
+  const long long q = 100000000;
+  const char* in_path = "FenwickStream.txt";
+  const char* out_path = "FenwickStreamo.txt";
+  FILE* in = fopen(in_path, "w+");
+  FILE* out = fopen(out_path, "w");
+  io::set_output(in);
+  io::write_int(n, ' ');
+  io::write_int(q, '\n');
+  mt19937 rng(q);
+  for (long long k = 0; k < q; k++) {
+    if (k % 2) {
+      io::write_word("+ ");
+      io::write_int(rng() % n, ' ');
+      io::write_int((int)(rng() % 2000001) - 1000000, '\n');
+    } else {
+      io::write_word("? ");
+      io::write_int(rng() % (n + 1), '\n');
+    }
+  }
+  io::set_output(out);
+  fflush(in);
+  cout << q << " commands, " << ftell(in) / (1 << 20) << " MiB\n";
+
+  rewind(in);
+  auto start = chrono::steady_clock::now();
+  io::set_input(in);
+  long long done = run_fenwick_commands();
+  io::Flusher::flush();
+  assert(done == q);
+  cout << "  run_fenwick_commands: " << seconds_since(start)
+       << "s\n";
+
+  io::set_output(stdout);
+  io::set_input(stdin);
+  fclose(in);
+  fclose(out);
+
+  // what fenwick.cpp's main used to do, on the same file
+  start = chrono::steady_clock::now();
+  {
+    ifstream s_in(in_path);
+    ofstream s_out(out_path);
+    string op;
+    int size, x;
+    long long count, delta;
+    s_in >> size >> count;
+    Fenwick<long long> fenwick(size);
+    for (long long k = 0; k < count; k++) {
+      s_in >> op;
+      if (op[0] == '+') {
+        s_in >> x >> delta;
+        fenwick.modify(x, delta);
+      } else {
+        s_in >> x;
+        s_out << fenwick.query(x) << '\n';
+      }
+    }
+    s_out.flush();
+  }
+  cout << "  istream >>: " << seconds_since(start) << "s\n";
+  remove(in_path);
+  remove(out_path);
+}
+
+void benchmarkFenwick() {
+  benchmarkFenwickStream();
+  benchmarkFenwickLowerBound();
+  benchmarkConcurrentFenwick();
+  benchmarkLargeFenwick();
+}
@@ -0,0 +1,288 @@
+#include <bits/stdc++.h>
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include "Flow.cpp"
+#include "Timing.cpp"
+using namespace std;
+
+struct FlowGraph {
+  int n, s, t;
+  vector<array<int, 3>> edges;
+};
+
+// s, left, right, t. each left to right pair is an edge with probability
+// density / 100. the s and t edges carry about as much as the middle ones
+// around their vertex, so the minimum cut mixes both
+FlowGraph dense_bipartite(int side, int density, int max_cap, int seed) {
+  mt19937 rng(seed);
+  FlowGraph g{2 * side + 2, 2 * side, 2 * side + 1, {}};
+  int terminal_cap = max(1, max_cap * side * density / 200);
+  for (int i = 0; i < side; i++) {
+    g.edges.push_back({g.s, i, (int)(rng() % terminal_cap) + 1});
+    g.edges.push_back({side + i, g.t, (int)(rng() % terminal_cap) + 1});
+  }
+  for (int i = 0; i < side; i++) {
+    for (int j = 0; j < side; j++) {
+      if ((int)(rng() % 100) < density) {
+        g.edges.push_back({i, side + j, (int)(rng() % max_cap) + 1});
+      }
+    }
+  }
+  return g;
+}
+
+// image segmentation style: a 4 connected grid of pixels, each tied to s
+// and t with its own weights
+FlowGraph segmentation_grid(int rows, int cols, int seed) {
+  mt19937 rng(seed);
+  int pixels = rows * cols;
+  FlowGraph g{pixels + 2, pixels, pixels + 1, {}};
+  for (int r = 0; r < rows; r++) {
+    for (int c = 0; c < cols; c++) {
+      int v = r * cols + c;
+      g.edges.push_back({g.s, v, (int)(rng() % 100)});
+      g.edges.push_back({v, g.t, (int)(rng() % 100)});
+      if (c + 1 < cols) {
+        int w = (int)(rng() % 50);
+        g.edges.push_back({v, v + 1, w});
+        g.edges.push_back({v + 1, v, w});
+      }
+      if (r + 1 < rows) {
+        int w = (int)(rng() % 50);
+        g.edges.push_back({v, v + cols, w});
+        g.edges.push_back({v + cols, v, w});
+      }
+    }
+  }
+  return g;
+}
+
+// the pixel grid alone, from the top left to the bottom right corner, so
+// the augmenting paths are long
+FlowGraph corner_grid(int rows, int cols, int seed) {
+  FlowGraph g = segmentation_grid(rows, cols, seed);
+  g.edges.erase(remove_if(g.edges.begin(), g.edges.end(),
+                          [&](const array<int, 3>& e) {
+                            return e[0] == g.s || e[1] == g.t;
+                          }),
+                g.edges.end());
+  g.n = rows * cols, g.s = 0, g.t = rows * cols - 1;
+  return g;
+}
+
+FlowGraph random_flow_graph(int n, int m, int max_cap, int seed) {
+  mt19937 rng(seed);
+  FlowGraph g{n, 0, n - 1, {}};
+  for (int i = 0; i < m; i++) {
+    g.edges.push_back(
+        {(int)(rng() % n), (int)(rng() % n), (int)(rng() % max_cap)});
+  }
+  return g;
+}
+
+template <class I, class E>
+void add_flow_graph(Flow<I, E>& flow, const FlowGraph& g) {
+  for (auto& e : g.edges) {
+    flow.add_edge(e[0], e[1], e[2]);
+  }
+}
+
+// capacities hold and everything but s and t is balanced
+template <class I, class E>
+bool is_valid_flow(const Flow<I, E>& flow, I s, I t, E value) {
+  vector<E> balance(flow.n);
+  for (size_t i = 0; i < flow.Edges.size(); i += 2) {
+    const Edge<I, E>& edge = flow.Edges[i];
+    if (edge.flow < 0 || edge.flow > edge.capacity) return false;
+    if (flow.Edges[i + 1].flow != -edge.flow) return false;
+    balance[edge.u] -= edge.flow;
+    balance[edge.v] += edge.flow;
+  }
+  for (I v = 0; v < flow.n; v++) {
+    if (v != s && v != t && balance[v] != 0) return false;
+  }
+  return balance[t] == value && balance[s] == -value;
+}
+
+void testFlowSmall(FlowAlgorithm algorithm) {
+  Flow<int, int> flo(10, algorithm);
+  flo.add_edge(0, 1, 3);
+  flo.add_edge(1, 2, 3);
+  flo.add_edge(0, 2, 3);
+  flo.add_edge(0, 4, 3);
+  flo.add_edge(4, 2, 3);
+  assert(flo.max_flow(0, 2) == 9);
+  assert(is_valid_flow(flo, 0, 2, 9));
+  // more flow on top of the previous one
+  flo.add_edge(0, 3, 5);
+  flo.add_edge(3, 2, 4);
+  assert(flo.max_flow(0, 2) == 4);
+  assert(is_valid_flow(flo, 0, 2, 13));
+}
+
+void testPushRelabel() {
+  for (int seed = 0; seed < 200; seed++) {
+    int n = seed % 20 + 2;
+    FlowGraph g = random_flow_graph(n, seed % 60, 1 + seed % 10, seed);
+    Flow<int, int> dinic(n);
+    Flow<int, int> push_relabel(n, FlowAlgorithm::kPushRelabel);
+    add_flow_graph(dinic, g);
+    add_flow_graph(push_relabel, g);
+    int expected = dinic.max_flow(g.s, g.t);
+    assert(push_relabel.max_flow(g.s, g.t) == expected);
+    assert(is_valid_flow(push_relabel, g.s, g.t, expected));
+  }
+  vector<FlowGraph> graphs = {dense_bipartite(60, 30, 20, 1),
+                              segmentation_grid(30, 40, 2)};
+  for (auto& g : graphs) {
+    Flow<int, long long> dinic(g.n);
+    Flow<int, long long> push_relabel(g.n, FlowAlgorithm::kPushRelabel);
+    add_flow_graph(dinic, g);
+    add_flow_graph(push_relabel, g);
+    long long expected = dinic.max_flow(g.s, g.t);
+    assert(push_relabel.max_flow(g.s, g.t) == expected);
+    assert(is_valid_flow(push_relabel, g.s, g.t, expected));
+  }
+}
+
+void testFlowFrozen() {
+  for (int seed = 0; seed < 200; seed++) {
+    int n = seed % 20 + 2;
+    FlowGraph g = random_flow_graph(n, seed % 60, 1 + seed % 10, seed);
+    Flow<int, int> dinic(n);
+    Flow<int, int> frozen(n);
+    add_flow_graph(dinic, g);
+    add_flow_graph(frozen, g);
+    frozen.freeze();
+    int expected = dinic.max_flow(g.s, g.t);
+    assert(frozen.max_flow(g.s, g.t) == expected);
+    assert(is_valid_flow(frozen, g.s, g.t, expected));
+    // an edge added after freeze is seen, frozen again or not
+    dinic.add_edge(g.s, g.t, 7);
+    frozen.add_edge(g.s, g.t, 7);
+    if (seed % 2) frozen.freeze();
+    assert(dinic.max_flow(g.s, g.t) == 7);
+    assert(frozen.max_flow(g.s, g.t) == 7);
+    assert(is_valid_flow(frozen, g.s, g.t, expected + 7));
+  }
+  // push relabel continues from the flow the frozen Dinic wrote back
+  FlowGraph g = segmentation_grid(30, 40, 5);
+  Flow<int, long long> flow(g.n);
+  add_flow_graph(flow, g);
+  flow.freeze();
+  long long total = flow.max_flow(g.s, g.t);
+  flow.add_edge(g.s, 7, 1000);
+  flow.algorithm = FlowAlgorithm::kPushRelabel;
+  total += flow.max_flow(g.s, g.t);
+  assert(is_valid_flow(flow, g.s, g.t, total));
+  Flow<int, long long> dinic(g.n);
+  add_flow_graph(dinic, g);
+  dinic.add_edge(g.s, 7, 1000);
+  assert(dinic.max_flow(g.s, g.t) == total);
+}
+
+// a path of 10^6 vertices and a 1000 x 1000 grid from corner to corner,
+// far deeper than a recursive dfs gets
+void testFlowLongPaths() {
+  const int n = 1000000;
+  FlowGraph path{n, 0, n - 1, {}};
+  for (int i = 0; i + 1 < n; i++) {
+    path.edges.push_back({i, i + 1, 5 + i % 1000});
+  }
+  FlowGraph grid = corner_grid(1000, 1000, 7);
+  for (bool freeze : {false, true}) {
+    Flow<int, int> flow(n);
+    add_flow_graph(flow, path);
+    if (freeze) flow.freeze();
+    assert(flow.max_flow(path.s, path.t) == 5);
+    assert(is_valid_flow(flow, path.s, path.t, 5));
+  }
+  long long expected = -1;
+  for (bool freeze : {false, true}) {
+    Flow<int, long long> flow(grid.n);
+    add_flow_graph(flow, grid);
+    if (freeze) flow.freeze();
+    long long value = flow.max_flow(grid.s, grid.t);
+    assert(expected < 0 || value == expected);
+    assert(is_valid_flow(flow, grid.s, grid.t, value));
+    expected = value;
+  }
+  Flow<int, long long> flow(grid.n, FlowAlgorithm::kPushRelabel);
+  add_flow_graph(flow, grid);
+  assert(flow.max_flow(grid.s, grid.t) == expected);
+}
+
+// capacities above INF, which the blocking flow must not cap at
+void testFlowLargeCapacities() {
+  for (bool freeze : {false, true}) {
+    Flow<int, int> flow(3);
+    flow.add_edge(0, 1, 2000000000);
+    flow.add_edge(1, 2, 2000000000);
+    if (freeze) flow.freeze();
+    assert(flow.max_flow(0, 2) == 2000000000);
+    assert(is_valid_flow(flow, 0, 2, 2000000000));
+  }
+}
+
+void testFlow() {
+  testFlowSmall(FlowAlgorithm::kDinic);
+  testFlowSmall(FlowAlgorithm::kPushRelabel);
+  testPushRelabel();
+  testFlowFrozen();
+  testFlowLongPaths();
+  testFlowLargeCapacities();
+}
+
+void benchmark_flow_graph(const string& name, const FlowGraph& g) {
+  cout << name << ", " << g.n << " vertices, " << g.edges.size()
+       << " edges\n";
+  long long expected = -1;
+  for (auto algorithm : {FlowAlgorithm::kDinic, FlowAlgorithm::kPushRelabel}) {
+    Flow<int, long long> flow(g.n, algorithm);
+    add_flow_graph(flow, g);
+    auto start = chrono::steady_clock::now();
+    long long value = flow.max_flow(g.s, g.t);
+    double elapsed = seconds_since(start);
+    assert(expected < 0 || value == expected);
+    expected = value;
+    cout << "  "
+         << (algorithm == FlowAlgorithm::kDinic ? "dinic" : "push relabel")
+         << ": " << elapsed << "s, flow " << value << '\n';
+  }
+}
+
+// Dinic over Graph and Edges against Dinic over the frozen arrays
+void benchmark_frozen_flow(const string& name, const FlowGraph& g) {
+  cout << name << ", " << g.n << " vertices, " << g.edges.size()
+       << " edges\n";
+  long long expected = -1;
+  for (bool freeze : {false, true}) {
+    Flow<int, long long> flow(g.n);
+    add_flow_graph(flow, g);
+    auto start = chrono::steady_clock::now();
+    if (freeze) {
+      flow.freeze();
+      cout << "  freeze: " << seconds_since(start) << "s\n";
+    }
+    long long value = flow.max_flow(g.s, g.t);
+    double elapsed = seconds_since(start);
+    assert(expected < 0 || value == expected);
+    expected = value;
+    cout << "  " << (freeze ? "frozen dinic" : "dinic") << ": " << elapsed
+         << "s, flow " << value << '\n';
+  }
+}
+
+void benchmarkFlow() {
+  benchmark_flow_graph("dense bipartite", dense_bipartite(2000, 50, 1000, 3));
+  benchmark_flow_graph("segmentation grid",
+                       segmentation_grid(1000, 1000, 4));
+  benchmark_flow_graph("corner grid", corner_grid(1000, 1000, 8));
+  benchmark_frozen_flow("dense bipartite",
+                        dense_bipartite(4500, 50, 1000, 5));
+  benchmark_frozen_flow("random",
+                        random_flow_graph(1000000, 10000000, 1000, 6));
+}
@@ -0,0 +1,1093 @@
+#include <bits/stdc++.h>
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include "RMQ.cpp"
+#include "SegmentTree.cpp"
+#include "Timing.cpp"
+using namespace std;
+
+template <class E>
+vector<E> random_elements(int n, E lo, E hi) {
+  mt19937 rng(n);
+  uniform_int_distribution<long long> dist(lo, hi);
+  vector<E> elements(n);
+  for (auto& e : elements) {
+    e = dist(rng);
+  }
+  return elements;
+}
+
+// applies the same random modifications and queries to the tree and to a
+// plain array
+template <class Tree, class E, class M>
+void check_against_naive(Tree& tree, vector<E> elements, const M& merger,
+                         int ops) {
+  int n = elements.size();
+  mt19937 rng(ops);
+  for (int k = 0; k < ops; k++) {
+    int l = rng() % n, r = rng() % n;
+    if (l > r) swap(l, r);
+    r++;
+    if (rng() % 2) {
+      E value = rng() % 1000;
+      tree.modify(l, value);
+      elements[l] = value;
+    } else {
+      E expected = merger.identity();
+      for (int i = l; i < r; i++) {
+        expected = merger.merge(expected, elements[i]);
+      }
+      assert(tree.query(l, r) == expected);
+    }
+  }
+}
+
+void testSegmentTreeMergers() {
+  for (int n : {1, 2, 7, 64, 100, 1000}) {
+    vector<long long> elements = random_elements<long long>(n, -1000, 1000);
+    SegmentTree<int, long long, MySum<long long>> sum(elements);
+    check_against_naive(sum, elements, MySum<long long>(), 2000);
+    SegmentTree<int, long long, MyMin<long long>> mn(elements);
+    check_against_naive(mn, elements, MyMin<long long>(), 2000);
+    MyMax<long long> mymax;
+    SegmentTree<int, long long> mx(elements, mymax);
+    check_against_naive(mx, elements, mymax, 2000);
+    // default constructed with the runtime merger, then assigned
+    SegmentTree<int, long long> assigned;
+    StaticSegmentTree<int, long long> assigned_static;
+    assigned = SegmentTree<int, long long>(elements, mymax);
+    assigned_static = StaticSegmentTree<int, long long>(elements, mymax);
+    assert(assigned_static.query(0, n) ==
+           *max_element(elements.begin(), elements.end()));
+    check_against_naive(assigned, elements, mymax, 2000);
+  }
+
+  // UVA 11235, most frequent value in a range of a sorted array
+  vector<int> sorted = {-1, -1, 1, 1, 1, 1, 3, 10, 10, 10};
+  vector<Element> elements;
+  for (int v : sorted) {
+    elements.push_back(Element(1, v, 1, v, 1, v, 1));
+  }
+  Frequency frequency;
+  SegmentTree<int, Element> t(elements, frequency);
+  assert(t.query(1, 3).mf == 1);
+  assert(t.query(0, 10).mf == 4);
+  assert(t.query(0, 10).mv == 1);
+  assert(t.query(5, 10).mf == 3);
+}
+
+// random range updates drawn by make_update, checked against a plain array
+template <class E, class M, class A, class Update>
+void check_lazy_against_naive(int n, Update make_update, int ops) {
+  M merger;
+  A action;
+  vector<E> elements = random_elements<E>(n, -100, 100);
+  SegmentTreeLazy<int, E, M, A> tree(elements);
+  mt19937 rng(n);
+  for (int k = 0; k < ops; k++) {
+    int l = rng() % n, r = rng() % n;
+    if (l > r) swap(l, r);
+    r++;
+    if (rng() % 2) {
+      auto f = make_update(rng);
+      tree.modify(l, r, f);
+      for (int i = l; i < r; i++) {
+        elements[i] = action.apply(f, elements[i], 1);
+      }
+    } else {
+      E expected = merger.identity();
+      for (int i = l; i < r; i++) {
+        expected = merger.merge(expected, elements[i]);
+      }
+      assert(tree.query(l, r) == expected);
+    }
+  }
+}
+
+void testSegmentTreeLazyActions() {
+  typedef long long ll;
+  auto add = [](mt19937& rng) { return (ll)(rng() % 21) - 10; };
+  auto assign = [](mt19937& rng) {
+    return Assignment<ll>(true, (ll)(rng() % 201) - 100);
+  };
+  auto affine = [](mt19937& rng) {
+    return Affine<ll>((ll)(rng() % 3) - 1, (ll)(rng() % 21) - 10);
+  };
+  for (int n : {1, 2, 3, 5, 16, 20, 100, 777}) {
+    check_lazy_against_naive<ll, MySum<ll>, AddSum<ll>>(n, add, 3000);
+    check_lazy_against_naive<ll, MyMin<ll>, AddMinMax<ll>>(n, add, 3000);
+    check_lazy_against_naive<ll, MyMax<ll>, AddMinMax<ll>>(n, add, 3000);
+    check_lazy_against_naive<ll, MySum<ll>, AssignSum<ll>>(n, assign, 3000);
+    check_lazy_against_naive<ll, MyMin<ll>, AssignMinMax<ll>>(n, assign,
+                                                             3000);
+    check_lazy_against_naive<ll, MySum<ll>, AffineSum<ll>>(n, affine, 3000);
+  }
+}
+
+template <class E, class M>
+void check_static_against_naive(int n, int queries) {
+  M merger;
+  vector<E> elements = random_elements<E>(n, -30000, 30000);
+  StaticSegmentTree<int, E, M> tree(elements);
+  mt19937 rng(n);
+  for (int k = 0; k < queries; k++) {
+    int l = rng() % (n + 1), r = rng() % (n + 1);
+    if (l > r) swap(l, r);
+    E expected = merger.identity();
+    for (int i = l; i < r; i++) {
+      expected = merger.merge(expected, elements[i]);
+    }
+    assert(tree.query(l, r) == expected);
+  }
+}
+
+void testStaticSegmentTree() {
+  for (int n : {1, 2, 15, 16, 17, 100, 256, 1000, 5000}) {
+    check_static_against_naive<int, MySum<int>>(n, 1000);
+    check_static_against_naive<int, MyMin<int>>(n, 1000);
+    check_static_against_naive<int, MyMax<int>>(n, 1000);
+    check_static_against_naive<long long, MySum<long long>>(n, 1000);
+    check_static_against_naive<long long, MyMin<long long>>(n, 1000);
+    check_static_against_naive<long long, MyMax<long long>>(n, 1000);
+    check_static_against_naive<short, MyMax<short>>(n, 1000);
+  }
+
+  // merge order matters for Frequency. ties may pick different values, so
+  // only the frequencies are compared
+  vector<Element> elements;
+  mt19937 rng(7);
+  for (int i = 0, v = 0; i < 3000; i++) {
+    v += rng() % 3 == 0;
+    elements.push_back(Element(1, v, 1, v, 1, v, 1));
+  }
+  Frequency frequency;
+  SegmentTree<int, Element> tree(elements, frequency);
+  StaticSegmentTree<int, Element> flat(elements, frequency);
+  for (int k = 0; k < 3000; k++) {
+    int l = rng() % 3000, r = rng() % 3000;
+    if (l > r) swap(l, r);
+    r++;
+    assert(flat.query(l, r).mf == tree.query(l, r).mf);
+  }
+}
+
+void testSegmentTreeBatch() {
+  mt19937 rng(33);
+  for (int n : {1, 2, 3, 7, 100, 1000, 30000}) {
+    vector<int> elements = random_elements<int>(n, -1000, 1000);
+    SegmentTree<int, int, MySum<int>> one(elements), batch(elements);
+    SegmentTree<int, int, MyMin<int>> min_one(elements), min_batch(elements);
+    for (int round = 0; round < 5; round++) {
+      vector<pair<int, int>> updates(rng() % (2 * n) + 1);
+      for (auto& update : updates) {
+        update = make_pair(rng() % n, rng() % 2001 - 1000);
+        one.modify(update.first, update.second);
+        min_one.modify(update.first, update.second);
+      }
+      batch.modify_batch(updates);
+      min_batch.modify_batch(updates);
+      vector<pair<int, int>> queries(10000);
+      for (auto& query : queries) {
+        int l = rng() % (n + 1), r = rng() % (n + 1);
+        query = make_pair(min(l, r), max(l, r));
+      }
+      for (int threads : {1, 3}) {
+        vector<int> results, min_results;
+        batch.query_batch(queries, results, threads);
+        min_batch.query_batch(queries, min_results, threads);
+        for (size_t k = 0; k < queries.size(); k++) {
+          assert(results[k] == one.query(queries[k].first, queries[k].second));
+          assert(min_results[k] ==
+                 min_one.query(queries[k].first, queries[k].second));
+        }
+      }
+    }
+  }
+}
+
+void testPersistentSegmentTree() {
+  mt19937 rng(34);
+  for (int n : {1, 2, 5, 64, 1000}) {
+    vector<vector<int>> naive(1, random_elements<int>(n, -1000, 1000));
+    PersistentSegmentTree<int, int, MySum<int>> sum(naive[0]);
+    PersistentSegmentTree<int, int, MyMin<int>> mn(naive[0]);
+    for (int k = 0; k < 300; k++) {
+      size_t version = rng() % naive.size();
+      int i = rng() % n, value = rng() % 2001 - 1000;
+      naive.push_back(naive[version]);
+      naive.back()[i] = value;
+      assert(sum.modify(version, i, value) == naive.size() - 1);
+      assert(mn.modify(version, i, value) == naive.size() - 1);
+    }
+    assert(sum.versions() == naive.size());
+    for (int k = 0; k < 3000; k++) {
+      size_t version = rng() % naive.size();
+      int l = rng() % (n + 1), r = rng() % (n + 1);
+      if (l > r) swap(l, r);
+      auto first = naive[version].begin();
+      assert(sum.query(version, l, r) == accumulate(first + l, first + r, 0));
+      if (l < r) {
+        assert(mn.query(version, l, r) == *min_element(first + l, first + r));
+      }
+    }
+  }
+  // k-th smallest of a range, version i counts the values of the first i
+  // elements
+  const int n = 2000, values = 500;
+  vector<int> elements = random_elements<int>(n, 0, values - 1);
+  PersistentSegmentTree<int, int, MySum<int>> counts(values);
+  for (int i = 0; i < n; i++) {
+    int ct = counts.query(i, elements[i], elements[i] + 1);
+    counts.modify(i, elements[i], ct + 1);
+  }
+  for (int k = 0; k < 2000; k++) {
+    int l = rng() % n, r = rng() % n;
+    if (l > r) swap(l, r);
+    vector<int> sorted(elements.begin() + l, elements.begin() + r + 1);
+    sort(sorted.begin(), sorted.end());
+    int kth = rng() % sorted.size();
+    assert(counts.kth(l, r + 1, kth) == sorted[kth]);
+  }
+}
+
+// same as check_lazy_against_naive with point assignments mixed in, over
+// elements that start at E()
+template <class E, class M, class A, class Update>
+void check_sparse_against_naive(int n, Update make_update, int ops) {
+  M merger;
+  A action;
+  vector<E> elements(n);
+  SparseSegmentTree<E, M, A> tree(n);
+  mt19937 rng(n);
+  for (int k = 0; k < ops; k++) {
+    int l = rng() % n, r = rng() % n;
+    if (l > r) swap(l, r);
+    r++;
+    if (rng() % 4 == 0) {
+      E value = (E)(rng() % 201) - 100;
+      tree.modify(l, value);
+      elements[l] = value;
+    } else if (rng() % 2) {
+      auto f = make_update(rng);
+      tree.modify(l, r, f);
+      for (int i = l; i < r; i++) {
+        elements[i] = action.apply(f, elements[i], 1);
+      }
+    } else {
+      E expected = merger.identity();
+      for (int i = l; i < r; i++) {
+        expected = merger.merge(expected, elements[i]);
+      }
+      assert(tree.query(l, r) == expected);
+    }
+  }
+}
+
+void testSparseSegmentTree() {
+  typedef long long ll;
+  auto add = [](mt19937& rng) { return (ll)(rng() % 21) - 10; };
+  auto assign = [](mt19937& rng) {
+    return Assignment<ll>(true, (ll)(rng() % 201) - 100);
+  };
+  for (int n : {1, 2, 3, 5, 16, 100, 777}) {
+    check_sparse_against_naive<ll, MySum<ll>, AddSum<ll>>(n, add, 3000);
+    check_sparse_against_naive<ll, MyMin<ll>, AddMinMax<ll>>(n, add, 3000);
+    check_sparse_against_naive<ll, MySum<ll>, AssignSum<ll>>(n, assign, 3000);
+    check_sparse_against_naive<ll, MyMax<ll>, AssignMinMax<ll>>(n, assign,
+                                                               3000);
+  }
+  // sparse keys over the whole default range, then range adds over [0, 2^40)
+  mt19937_64 rng(35);
+  SparseSegmentTree<ll> tree;
+  map<uint64_t, ll> points;
+  for (int k = 0; k < 2000; k++) {
+    uint64_t key = rng() >> 1;
+    ll value = rng() % 1000;
+    tree.modify(key, value);
+    points[key] = value;
+  }
+  for (int k = 0; k < 2000; k++) {
+    uint64_t l = rng() >> 1, r = rng() >> 1;
+    if (l > r) swap(l, r);
+    ll expected = 0;
+    for (auto it = points.lower_bound(l); it != points.end() && it->first < r;
+         it++) {
+      expected += it->second;
+    }
+    assert(tree.query(l, r) == expected);
+  }
+  SparseSegmentTree<ll> adds(1ull << 40);
+  vector<pair<pair<uint64_t, uint64_t>, ll>> updates;
+  for (int k = 0; k < 4000; k++) {
+    uint64_t l = rng() >> 24, r = rng() >> 24;
+    if (l > r) swap(l, r);
+    if (k % 2 == 0) {
+      ll f = rng() % 21 - 10;
+      adds.modify(l, r, f);
+      updates.push_back(make_pair(make_pair(l, r), f));
+    } else {
+      ll expected = 0;
+      for (auto& update : updates) {
+        uint64_t lo = max(l, update.first.first);
+        uint64_t hi = min(r, update.first.second);
+        if (lo < hi) expected += (ll)(hi - lo) * update.second;
+      }
+      assert(adds.query(l, r) == expected);
+    }
+  }
+  assert(adds.nodes() < 4000 * 4 * 41);
+  // updates over the whole default range [0, 2^63). the root sum only fits
+  // in a wider type, but with long long the small ranges stay exact
+  const uint64_t full = 1ull << 63;
+  SparseSegmentTree<ll> whole;
+  whole.modify(0, full, 3);
+  assert(whole.query(full / 2 - 5, full / 2 + 5) == 30);
+  assert(whole.query(full - 1, full) == 3);
+  SparseSegmentTree<__int128> wide;
+  wide.modify(0, full, 1);
+  wide.modify(full / 2, full, -1);
+  assert(wide.query(0, full) == (__int128)(full / 2));
+  assert(wide.query(full / 2 - 5, full / 2 + 5) == 5);
+  // keys past the size are rejected instead of landing on the last leaf
+  SparseSegmentTree<ll> small(1000);
+  int thrown = 0;
+  for (int k = 0; k < 4; k++) {
+    try {
+      if (k == 0) small.modify(1000, 7);
+      if (k == 1) small.modify(999, 1001, 7);
+      if (k == 2) small.query(0, 1001);
+      if (k == 3) whole.modify(full + 5, 7);
+    } catch (const out_of_range&) {
+      thrown++;
+    }
+  }
+  assert(thrown == 4 && small.query(0, 1000) == 0);
+  small.modify(999, 7);
+  assert(small.query(999, 1000) == 7);
+}
+
+void testConcurrentSegmentTree() {
+  mt19937 rng(36);
+  for (int n : {1, 5, 1000}) {
+    vector<int> elements = random_elements<int>(n, -1000, 1000);
+    SegmentTree<int, int, MyMin<int>> expected(elements);
+    ConcurrentSegmentTree<int, int, MyMin<int>> tree(elements);
+    for (int k = 0; k < 2000; k++) {
+      int l = rng() % (n + 1), r = rng() % (n + 1);
+      if (l > r) swap(l, r);
+      if (k % 10 == 0) {
+        vector<pair<int, int>> updates(rng() % 20);
+        for (auto& update : updates) {
+          update = make_pair(rng() % n, rng() % 2001 - 1000);
+          expected.modify(update.first, update.second);
+        }
+        tree.modify_batch(updates);
+      } else if (k % 2) {
+        int value = rng() % 2001 - 1000;
+        expected.modify(l % n, value);
+        tree.modify(l % n, value);
+      }
+      assert(tree.query(l, r) == expected.query(l, r));
+    }
+  }
+  // every batch moves amounts between elements, so readers must always see
+  // the same total
+  const int n = 4096, total = 1000 * n;
+  ConcurrentSegmentTree<int, long long, MySum<long long>> tree(
+      vector<long long>(n, 1000));
+  atomic<bool> done(false);
+  vector<thread> readers;
+  for (int t = 0; t < 3; t++) {
+    readers.emplace_back([&] {
+      while (!done) {
+        assert(tree.query(0, n) == total);
+      }
+    });
+  }
+  vector<long long> values(n, 1000);
+  for (int k = 0; k < 3000; k++) {
+    vector<pair<int, long long>> updates;
+    for (int j = 0; j < 8; j++) {
+      int from = rng() % n, to = rng() % n;
+      if (from == to) continue;
+      long long amount = rng() % 100;
+      values[from] -= amount;
+      values[to] += amount;
+      updates.push_back(make_pair(from, values[from]));
+      updates.push_back(make_pair(to, values[to]));
+    }
+    tree.modify_batch(updates);
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  for (int i = 0; i < n; i++) {
+    assert(tree.query(i, i + 1) == values[i]);
+  }
+  // amounts only move within pairs (2i, 2i + 1), so every range of whole
+  // pairs keeps its sum, whether it lies in one block or spans many
+  ConcurrentSegmentTree<int, long long, MySum<long long>> pairs(
+      vector<long long>(n, 1000));
+  done = false;
+  readers.clear();
+  for (int t = 0; t < 3; t++) {
+    readers.emplace_back([&, t] {
+      mt19937 rng(t);
+      while (!done) {
+        int a = rng() % (n / 2 + 1), b = rng() % (n / 2 + 1);
+        if (a > b) swap(a, b);
+        // reader 0 stays within a block or two
+        if (t == 0) b = min(b, a + 16);
+        assert(pairs.query(2 * a, 2 * b) == 2000ll * (b - a));
+      }
+    });
+  }
+  values.assign(n, 1000);
+  for (int k = 0; k < 3000; k++) {
+    vector<pair<int, long long>> updates;
+    for (int j = 0; j < 8; j++) {
+      int from = rng() % n, to = from ^ 1;
+      long long amount = rng() % 100;
+      values[from] -= amount;
+      values[to] += amount;
+      updates.push_back(make_pair(from, values[from]));
+      updates.push_back(make_pair(to, values[to]));
+    }
+    pairs.modify_batch(updates);
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  for (int i = 0; i < n; i++) {
+    assert(pairs.query(i, i + 1) == values[i]);
+  }
+}
+
+template <class M>
+void check_2d_against_naive(int n, int m, int ops) {
+  M merger;
+  mt19937 rng(n * m);
+  vector<vector<int>> grid(n);
+  for (auto& row : grid) {
+    row = random_elements<int>(m, -1000, 1000);
+  }
+  SegmentTree2D<int, int, M> tree(grid);
+  for (int k = 0; k < ops; k++) {
+    int x1 = rng() % n, x2 = rng() % n, y1 = rng() % m, y2 = rng() % m;
+    if (x1 > x2) swap(x1, x2);
+    if (y1 > y2) swap(y1, y2);
+    if (k % 2) {
+      grid[x1][y1] = rng() % 2001 - 1000;
+      tree.modify(x1, y1, grid[x1][y1]);
+    } else {
+      int expected = merger.identity();
+      for (int x = x1; x <= x2; x++) {
+        for (int y = y1; y <= y2; y++) {
+          expected = merger.merge(expected, grid[x][y]);
+        }
+      }
+      assert(tree.query(x1, y1, x2 + 1, y2 + 1) == expected);
+    }
+  }
+}
+
+void testSegmentTree2D() {
+  for (auto size : vector<pair<int, int>>{{1, 1}, {1, 7}, {3, 5}, {17, 9},
+                                          {64, 64}}) {
+    check_2d_against_naive<MySum<int>>(size.first, size.second, 2000);
+    check_2d_against_naive<MyMin<int>>(size.first, size.second, 2000);
+    check_2d_against_naive<MyMax<int>>(size.first, size.second, 2000);
+  }
+}
+
+void testSegmentTreeBeats() {
+  typedef long long ll;
+  mt19937 rng(38);
+  for (int n : {1, 2, 3, 8, 13, 100, 500}) {
+    vector<ll> elements = random_elements<ll>(n, -1000, 1000);
+    SegmentTreeBeats<int, ll> tree(elements);
+    for (int k = 0; k < 5000; k++) {
+      int l = rng() % n, r = rng() % n;
+      if (l > r) swap(l, r);
+      r++;
+      ll value = (ll)(rng() % 2001) - 1000;
+      switch (rng() % 6) {
+        case 0:
+          tree.chmin(l, r, value);
+          for (int i = l; i < r; i++) elements[i] = min(elements[i], value);
+          break;
+        case 1:
+          tree.chmax(l, r, value);
+          for (int i = l; i < r; i++) elements[i] = max(elements[i], value);
+          break;
+        case 2:
+          tree.add(l, r, value / 10);
+          for (int i = l; i < r; i++) elements[i] += value / 10;
+          break;
+        default:
+          assert(tree.query_sum(l, r) ==
+                 accumulate(elements.begin() + l, elements.begin() + r, 0ll));
+          assert(tree.query_min(l, r) ==
+                 *min_element(elements.begin() + l, elements.begin() + r));
+          assert(tree.query_max(l, r) ==
+                 *max_element(elements.begin() + l, elements.begin() + r));
+      }
+    }
+  }
+}
+
+// max_right and min_left against a linear scan, for a prefix sum bound and
+// a running min bound
+template <class Tree>
+void check_descent_against_naive(Tree& tree, const vector<long long>& a,
+                                 mt19937& rng) {
+  int n = a.size();
+  int l = rng() % (n + 1);
+  long long bound = (long long)(rng() % 2001) - 500;
+  auto sum_below = [&](long long sum) { return sum <= bound; };
+  int expected = l;
+  for (long long sum = 0; expected < n && sum + a[expected] <= bound;) {
+    sum += a[expected++];
+  }
+  assert(tree.max_right(l, sum_below) == expected);
+  expected = l;
+  for (long long sum = 0; expected > 0 && sum + a[expected - 1] <= bound;) {
+    sum += a[--expected];
+  }
+  assert(tree.min_left(l, sum_below) == expected);
+}
+
+void testSegmentTreeDescent() {
+  typedef long long ll;
+  mt19937 rng(39);
+  for (int n : {1, 2, 3, 5, 13, 64, 100, 777}) {
+    vector<ll> elements = random_elements<ll>(n, 0, 100);
+    vector<ll> lazy_elements = elements;
+    SegmentTree<int, ll, MySum<ll>> tree(elements);
+    SegmentTree<int, ll, MyMin<ll>> mn(elements);
+    SegmentTreeLazy<int, ll, MySum<ll>, AddSum<ll>> lazy(elements);
+    for (int k = 0; k < 1000; k++) {
+      int l = rng() % n, r = rng() % n;
+      if (l > r) swap(l, r);
+      r++;
+      ll value = rng() % 50;
+      if (k % 3 == 0) {
+        tree.modify(l, value);
+        mn.modify(l, value);
+        elements[l] = value;
+        lazy.modify(l, r, value);
+        for (int i = l; i < r; i++) lazy_elements[i] += value;
+      }
+      check_descent_against_naive(tree, elements, rng);
+      check_descent_against_naive(lazy, lazy_elements, rng);
+      // first index at or after l whose value is below the bound
+      ll bound = rng() % 60;
+      int expected = l;
+      while (expected < n && elements[expected] >= bound) expected++;
+      assert(mn.max_right(l, [&](ll x) { return x >= bound; }) == expected);
+    }
+  }
+}
+
+void testSegmentTreeBuild() {
+  mt19937 rng(40);
+  for (int n : {1, 2, 3, 5, 1000, 100000, 300001}) {
+    vector<int> elements = random_elements<int>(n, -1000, 1000);
+    SegmentTree<int, int, MySum<int>> copied(elements);
+    SegmentTree<int, int, MySum<int>> parallel(elements, MySum<int>(), 4);
+    SegmentTree<int, int, MySum<int>> moved(vector<int>(elements),
+                                            MySum<int>(), 3);
+    SegmentTree<int, int, MySum<int>> reloaded(vector<int>(n / 2 + 1));
+    reloaded.reload(elements.data(), elements.data() + n, 2);
+    for (int k = 0; k < 1000; k++) {
+      int l = rng() % (n + 1), r = rng() % (n + 1);
+      if (l > r) swap(l, r);
+      int expected = accumulate(elements.begin() + l, elements.begin() + r, 0);
+      assert(copied.query(l, r) == expected);
+      assert(parallel.query(l, r) == expected);
+      assert(moved.query(l, r) == expected);
+      assert(reloaded.query(l, r) == expected);
+    }
+  }
+}
+
+template <class M>
+void check_rmq_against_naive(int n, int values, mt19937& rng) {
+  M merger;
+  vector<int> elements = random_elements<int>(n, -values, values);
+  SparseTable<int, int, M> table(elements);
+  BlockRMQ<int, int, M> block(elements);
+  for (int k = 0; k < 2000; k++) {
+    int l = rng() % (n + 1), r = rng() % (n + 1);
+    if (l > r) swap(l, r);
+    int expected = merger.identity();
+    for (int i = l; i < r; i++) {
+      expected = merger.merge(expected, elements[i]);
+    }
+    assert(table.query(l, r) == expected);
+    assert(block.query(l, r) == expected);
+  }
+}
+
+void testStaticRMQ() {
+  mt19937 rng(41);
+  for (int n : {1, 2, 3, 63, 64, 65, 128, 200, 1000, 5000}) {
+    for (int values : {2, 1000000}) {
+      check_rmq_against_naive<MyMin<int>>(n, values, rng);
+      check_rmq_against_naive<MyMax<int>>(n, values, rng);
+    }
+  }
+}
+
+template <class Tree>
+double benchmark_tree(Tree& tree, int n, int ops) {
+  mt19937 rng(ops);
+  long long checksum = 0;
+  auto start = chrono::steady_clock::now();
+  for (int k = 0; k < ops; k++) {
+    int l = rng() % n, r = rng() % n;
+    if (l > r) swap(l, r);
+    if (k & 1) {
+      tree.modify(l, r);
+    } else {
+      checksum += tree.query(l, r + 1);
+    }
+  }
+  double elapsed = seconds_since(start);
+  if (checksum == 42) cout << '\n';
+  return elapsed;
+}
+
+void benchmarkSegmentTreeMergers() {
+  const int ops = 5000000;
+  for (int n : {1000000, 10000000}) {
+    vector<long long> elements = random_elements<long long>(n, 0, 1 << 30);
+    MySum<long long> mysum;
+    MyMin<long long> mymin;
+    SegmentTree<int, long long> dynamic_sum(elements, mysum);
+    SegmentTree<int, long long, MySum<long long>> static_sum(elements);
+    SegmentTree<int, long long> dynamic_min(elements, mymin);
+    SegmentTree<int, long long, MyMin<long long>> static_min(elements);
+    cout << "n = " << n << ", " << ops << " mixed query/modify\n";
+    cout << "  sum, virtual merger: " << benchmark_tree(dynamic_sum, n, ops)
+         << "s\n";
+    cout << "  sum, static merger: " << benchmark_tree(static_sum, n, ops)
+         << "s\n";
+    cout << "  min, virtual merger: " << benchmark_tree(dynamic_min, n, ops)
+         << "s\n";
+    cout << "  min, static merger: " << benchmark_tree(static_min, n, ops)
+         << "s\n";
+  }
+}
+
+template <class Tree>
+double benchmark_queries(const Tree& tree, int n, int queries) {
+  mt19937 rng(queries);
+  long long checksum = 0;
+  auto start = chrono::steady_clock::now();
+  for (int k = 0; k < queries; k++) {
+    int l = rng() % n, r = rng() % n;
+    if (l > r) swap(l, r);
+    checksum += tree.query(l, r + 1);
+  }
+  double elapsed = seconds_since(start);
+  if (checksum == 42) cout << '\n';
+  return elapsed / queries * 1e9;
+}
+
+void benchmarkStaticSegmentTree() {
+  const int queries = 2000000;
+  for (int n = 1 << 16; n <= (1 << 26); n <<= 2) {
+    vector<int> elements = random_elements<int>(n, 0, 1000);
+    SegmentTree<int, int, MySum<int>> sum(elements);
+    StaticSegmentTree<int, int, MySum<int>> static_sum(elements);
+    SegmentTree<int, int, MyMin<int>> mn(elements);
+    StaticSegmentTree<int, int, MyMin<int>> static_min(elements);
+    cout << "n = " << n << ", ns per query\n";
+    cout << "  sum, binary tree: " << benchmark_queries(sum, n, queries)
+         << ", static tree: " << benchmark_queries(static_sum, n, queries)
+         << '\n';
+    cout << "  min, binary tree: " << benchmark_queries(mn, n, queries)
+         << ", static tree: " << benchmark_queries(static_min, n, queries)
+         << '\n';
+  }
+}
+
+void benchmarkSegmentTreeBatch() {
+  const int n = 10000000, ops = 4000000;
+  vector<long long> elements = random_elements<long long>(n, 0, 1 << 30);
+  SegmentTree<int, long long, MySum<long long>> tree(elements);
+  mt19937 rng(1);
+  vector<pair<int, int>> queries(ops);
+  vector<pair<int, long long>> updates(ops);
+  for (int k = 0; k < ops; k++) {
+    int l = rng() % n, r = rng() % n;
+    queries[k] = make_pair(min(l, r), max(l, r) + 1);
+    updates[k] = make_pair(l, r);
+  }
+  cout << "n = " << n << ", batches of " << ops << '\n';
+  vector<long long> results(ops);
+  auto start = chrono::steady_clock::now();
+  for (int k = 0; k < ops; k++) {
+    results[k] = tree.query(queries[k].first, queries[k].second);
+  }
+  cout << "  query one by one: " << seconds_since(start) << "s\n";
+  for (int threads = 1; threads <= 4; threads <<= 1) {
+    start = chrono::steady_clock::now();
+    tree.query_batch(queries, results, threads);
+    cout << "  query_batch, " << threads
+         << " threads: " << seconds_since(start) << "s\n";
+  }
+  start = chrono::steady_clock::now();
+  for (auto& update : updates) {
+    tree.modify(update.first, update.second);
+  }
+  cout << "  modify one by one: " << seconds_since(start) << "s\n";
+  start = chrono::steady_clock::now();
+  tree.modify_batch(updates);
+  cout << "  modify_batch: " << seconds_since(start) << "s\n";
+}
+
+void benchmarkPersistentSegmentTree() {
+  const int n = 1000000, versions = 2000000, queries = 2000000;
+  vector<int> elements = random_elements<int>(n, 0, 1000);
+  PersistentSegmentTree<int, int, MySum<int>> tree(elements);
+  SegmentTree<int, int, MySum<int>> plain(elements);
+  mt19937 rng(1);
+  cout << "n = " << n << ", " << versions << " versions\n";
+  auto start = chrono::steady_clock::now();
+  for (int k = 0; k < versions; k++) {
+    tree.modify(rng() % tree.versions(), rng() % n, rng() % 1000);
+  }
+  cout << "  persistent modify: " << seconds_since(start) << "s, "
+       << tree.bytes() / (1 << 20) << " MiB, copying the tree per version "
+       << 2.0 * n * sizeof(int) * versions / (1 << 30) << " GiB\n";
+  start = chrono::steady_clock::now();
+  for (int k = 0; k < versions; k++) {
+    plain.modify(rng() % n, rng() % 1000);
+  }
+  cout << "  plain modify: " << seconds_since(start) << "s\n";
+  long long checksum = 0;
+  start = chrono::steady_clock::now();
+  for (int k = 0; k < queries; k++) {
+    int l = rng() % n, r = rng() % n;
+    if (l > r) swap(l, r);
+    checksum += tree.query(rng() % tree.versions(), l, r + 1);
+  }
+  cout << "  persistent query: " << seconds_since(start) << "s\n";
+  start = chrono::steady_clock::now();
+  for (int k = 0; k < queries; k++) {
+    int l = rng() % n, r = rng() % n;
+    if (l > r) swap(l, r);
+    checksum += plain.query(l, r + 1);
+  }
+  cout << "  plain query: " << seconds_since(start) << "s\n";
+  if (checksum == 42) cout << '\n';
+}
+
+void benchmarkSparseSegmentTree() {
+  const int events = 500000, queries = 2000000;
+  mt19937_64 rng(1);
+  vector<uint64_t> times(events);
+  for (auto& t : times) t = rng() >> 1;
+  cout << events << " events on 63-bit timestamps, " << queries
+       << " window counts\n";
+  auto start = chrono::steady_clock::now();
+  SparseSegmentTree<long long> sparse;
+  for (uint64_t t : times) sparse.modify(t, t + 1, 1);
+  cout << "  sparse tree, online: " << seconds_since(start) << "s, "
+       << sparse.nodes() << " nodes, " << sparse.bytes() / (1 << 20)
+       << " MiB\n";
+  start = chrono::steady_clock::now();
+  vector<uint64_t> keys = times;
+  sort(keys.begin(), keys.end());
+  keys.erase(unique(keys.begin(), keys.end()), keys.end());
+  SegmentTree<int, long long, MySum<long long>> compressed(
+      vector<long long>(keys.size()));
+  for (uint64_t t : times) {
+    int i = lower_bound(keys.begin(), keys.end(), t) - keys.begin();
+    compressed.modify(i, compressed.query(i, i + 1) + 1);
+  }
+  cout << "  compressed tree, offline: " << seconds_since(start) << "s\n";
+  vector<pair<uint64_t, uint64_t>> windows(queries);
+  for (auto& window : windows) {
+    uint64_t l = rng() >> 1, r = rng() >> 1;
+    window = make_pair(min(l, r), max(l, r));
+  }
+  long long checksum = 0;
+  start = chrono::steady_clock::now();
+  for (auto& window : windows) {
+    checksum += sparse.query(window.first, window.second);
+  }
+  cout << "  sparse tree queries: " << seconds_since(start) << "s\n";
+  start = chrono::steady_clock::now();
+  for (auto& window : windows) {
+    int l = lower_bound(keys.begin(), keys.end(), window.first) - keys.begin();
+    int r = lower_bound(keys.begin(), keys.end(), window.second) - keys.begin();
+    checksum -= compressed.query(l, r);
+  }
+  cout << "  compressed tree queries: " << seconds_since(start) << "s\n";
+  assert(checksum == 0);
+}
+
+// one writer publishes batches of `batch` updates while `readers` threads
+// query for `seconds`, returns queries and updates per second. with
+// disjoint, the readers stay in [0, n / 2) and the writer in [n / 2, n)
+template <class Query, class Publish>
+pair<double, double> benchmark_readers_writer(int n, int readers, int batch,
+                                              double seconds, Query query,
+                                              Publish publish,
+                                              bool disjoint = false) {
+  int half = disjoint ? n / 2 : n;
+  atomic<bool> done(false);
+  atomic<long long> queries(0);
+  vector<thread> threads;
+  for (int t = 0; t < readers; t++) {
+    threads.emplace_back([&, t] {
+      mt19937 rng(t);
+      long long ct = 0, checksum = 0;
+      while (!done) {
+        int l = rng() % half, r = rng() % half;
+        if (l > r) swap(l, r);
+        checksum += query(l, r + 1);
+        ct++;
+      }
+      queries += ct;
+      if (checksum == 42) cout << '\n';
+    });
+  }
+  mt19937 rng(readers);
+  long long updates = 0;
+  vector<pair<int, long long>> pending(batch);
+  auto start = chrono::steady_clock::now();
+  while (seconds_since(start) < seconds) {
+    for (auto& update : pending) {
+      update = make_pair(n - 1 - rng() % half, rng() % 1000);
+    }
+    publish(pending);
+    updates += batch;
+  }
+  done = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  double elapsed = seconds_since(start);
+  return make_pair(queries / elapsed, updates / elapsed);
+}
+
+void benchmarkConcurrentSegmentTree() {
+  typedef vector<pair<int, long long>> Updates;
+  const int n = 1000000;
+  const double seconds = 1;
+  vector<long long> elements = random_elements<long long>(n, 0, 1000);
+  SegmentTree<int, long long, MySum<long long>> locked(elements);
+  ConcurrentSegmentTree<int, long long, MySum<long long>> concurrent(
+      elements);
+  mutex global;
+  cout << "n = " << n << ", one writer, queries/s and updates/s, "
+       << thread::hardware_concurrency() << " hardware threads\n";
+  for (int batch : {1, 64}) {
+    for (int readers = 1; readers <= 8; readers <<= 1) {
+      auto mutexed = benchmark_readers_writer(
+          n, readers, batch, seconds,
+          [&](int l, int r) {
+            lock_guard<mutex> lock(global);
+            return locked.query(l, r);
+          },
+          [&](const Updates& updates) {
+            lock_guard<mutex> lock(global);
+            locked.modify_batch(updates);
+          });
+      auto query = [&](int l, int r) { return concurrent.query(l, r); };
+      auto publish = [&](const Updates& updates) {
+        concurrent.modify_batch(updates);
+      };
+      auto seqlock =
+          benchmark_readers_writer(n, readers, batch, seconds, query, publish);
+      auto disjoint = benchmark_readers_writer(n, readers, batch, seconds,
+                                               query, publish, true);
+      cout << "  batch " << batch << ", " << readers
+           << " readers, global mutex: " << mutexed.first << " "
+           << mutexed.second << ", seqlock: " << seqlock.first << " "
+           << seqlock.second << ", seqlock, writes elsewhere: "
+           << disjoint.first << " " << disjoint.second << '\n';
+    }
+  }
+}
+
+void benchmarkSegmentTree2D() {
+  const int n = 4096, ops = 40000;
+  vector<vector<int>> grid(n);
+  for (auto& row : grid) {
+    row = random_elements<int>(n, 0, 1 << 20);
+  }
+  SegmentTree2D<int, int, MyMin<int>> tree(grid);
+  vector<SegmentTree<int, int, MyMin<int>>> rows;
+  for (auto& row : grid) {
+    rows.emplace_back(row);
+  }
+  MyMin<int> merger;
+  cout << n << "x" << n << " grid, " << ops << " mixed min query/modify\n";
+  for (int per_row = 0; per_row < 2; per_row++) {
+    mt19937 rng(ops);
+    long long checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (int k = 0; k < ops; k++) {
+      int x1 = rng() % n, x2 = rng() % n, y1 = rng() % n, y2 = rng() % n;
+      if (x1 > x2) swap(x1, x2);
+      if (y1 > y2) swap(y1, y2);
+      if (k % 2) {
+        if (per_row) {
+          rows[x1].modify(y1, x2);
+        } else {
+          tree.modify(x1, y1, x2);
+        }
+      } else if (per_row) {
+        int res = merger.identity();
+        for (int x = x1; x <= x2; x++) {
+          res = merger.merge(res, rows[x].query(y1, y2 + 1));
+        }
+        checksum += res;
+      } else {
+        checksum += tree.query(x1, y1, x2 + 1, y2 + 1);
+      }
+    }
+    cout << (per_row ? "  per-row 1D trees: " : "  2D tree: ")
+         << seconds_since(start) << "s, checksum " << checksum << '\n';
+  }
+}
+
+void benchmarkSegmentTreeBeats() {
+  const int n = 1000000, ops = 2000000;
+  vector<long long> elements = random_elements<long long>(n, 0, 1 << 30);
+  SegmentTreeBeats<int, long long> tree(elements);
+  mt19937 rng(ops);
+  long long checksum = 0;
+  auto start = chrono::steady_clock::now();
+  for (int k = 0; k < ops; k++) {
+    int l = rng() % n, r = rng() % n;
+    if (l > r) swap(l, r);
+    long long value = rng() % (1 << 30);
+    switch (k % 4) {
+      case 0:
+        tree.chmin(l, r + 1, value);
+        break;
+      case 1:
+        tree.chmax(l, r + 1, value / 2);
+        break;
+      case 2:
+        tree.add(l, r + 1, value % 1000);
+        break;
+      default:
+        checksum += tree.query_sum(l, r + 1);
+    }
+  }
+  cout << "n = " << n << ", " << ops
+       << " chmin/chmax/add/sum, segment tree beats: " << seconds_since(start)
+       << "s\n";
+  if (checksum == 42) cout << '\n';
+}
+
+void benchmarkSegmentTreeDescent() {
+  const int n = 10000000, queries = 2000000;
+  vector<long long> elements = random_elements<long long>(n, 0, 1000);
+  SegmentTree<int, long long, MySum<long long>> tree(elements);
+  cout << "n = " << n << ", " << queries << " prefix sum searches\n";
+  for (int descent = 0; descent < 2; descent++) {
+    mt19937 rng(queries);
+    long long checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (int k = 0; k < queries; k++) {
+      int l = rng() % n;
+      long long bound = rng() % 100000000;
+      auto below = [&](long long sum) { return sum <= bound; };
+      if (descent) {
+        checksum += tree.max_right(l, below);
+        continue;
+      }
+      int lo = l, hi = n;
+      while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (below(tree.query(l, mid))) {
+          lo = mid;
+        } else {
+          hi = mid - 1;
+        }
+      }
+      checksum += lo;
+    }
+    cout << (descent ? "  max_right: " : "  binary search over query: ")
+         << seconds_since(start) << "s, checksum " << checksum << '\n';
+  }
+}
+
+void benchmarkSegmentTreeBuild() {
+  const int n = 50000000;
+  vector<long long> elements = random_elements<long long>(n, 0, 1 << 30);
+  cout << "n = " << n << " build, " << thread::hardware_concurrency()
+       << " hardware threads\n";
+  auto start = chrono::steady_clock::now();
+  {
+    SegmentTree<int, long long, MySum<long long>> tree(elements);
+    cout << "  copy, serial: " << seconds_since(start) << "s\n";
+  }
+  for (int threads = 1; threads <= 4; threads <<= 1) {
+    vector<long long> owned = elements;
+    owned.reserve(2 * n);
+    start = chrono::steady_clock::now();
+    SegmentTree<int, long long, MySum<long long>> tree(move(owned),
+                                                       MySum<long long>(),
+                                                       threads);
+    cout << "  move, " << threads << " threads: " << seconds_since(start)
+         << "s\n";
+    start = chrono::steady_clock::now();
+    tree.reload(elements.data(), elements.data() + n, threads);
+    cout << "  reload, " << threads << " threads: " << seconds_since(start)
+         << "s\n";
+  }
+}
+
+// bytes and ns per query. 10^9 ints need about 16 GB for the segment tree
+// and 12 GB for the block RMQ, and the sparse table grows with n log n, so
+// only the sizes that fit the machine are run
+void benchmarkStaticRMQ() {
+  const int queries = 2000000;
+  for (int n : {1000000, 10000000, 100000000}) {
+    vector<int> elements = random_elements<int>(n, 0, 1 << 30);
+    cout << "n = " << n << ", min, MiB and ns per query\n";
+    {
+      SegmentTree<int, int, MyMin<int>> tree(elements);
+      cout << "  binary tree: " << 2.0 * n * sizeof(int) / (1 << 20) << " "
+           << benchmark_queries(tree, n, queries) << '\n';
+    }
+    if (n <= 10000000) {
+      SparseTable<int, int, MyMin<int>> table(elements);
+      cout << "  sparse table: " << table.bytes() / (1 << 20) << " "
+           << benchmark_queries(table, n, queries) << '\n';
+    }
+    {
+      BlockRMQ<int, int, MyMin<int>> block(elements);
+      cout << "  block RMQ: " << block.bytes() / (1 << 20) << " "
+           << benchmark_queries(block, n, queries) << '\n';
+    }
+  }
+}
+
+void benchmarkSegmentTree() {
+  benchmarkSegmentTreeBatch();
+  benchmarkSegmentTreeMergers();
+  benchmarkStaticSegmentTree();
+  benchmarkPersistentSegmentTree();
+  benchmarkSparseSegmentTree();
+  benchmarkConcurrentSegmentTree();
+  benchmarkSegmentTree2D();
+  benchmarkSegmentTreeBeats();
+  benchmarkSegmentTreeDescent();
+  benchmarkSegmentTreeBuild();
+  benchmarkStaticRMQ();
+}
@@ -0,0 +1,231 @@
+#include <bits/stdc++.h>
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include "Sudoku.cpp"
+#include "Timing.cpp"
+using namespace std;
+
+vector<string> read_sudoku17(int limit) {
+  ifstream fin("sudoku/sudoku17.txt");
+  vector<string> puzzles;
+  string s;
+  while ((int)puzzles.size() < limit && fin >> s) {
+    puzzles.push_back(s);
+  }
+  return puzzles;
+}
+
+// first solved grid of sudoku.csv with its first `keep` cells kept
+void under_constrained_grid(int keep, char grid[81]) {
+  ifstream fin("sudoku/sudoku.csv");
+  string s;
+  fin >> s;
+  sudoku::Parse(s.substr(82), grid);
+  for (int i = keep; i < 81; i++) {
+    grid[i] = 0;
+  }
+}
+
+void testSudokuParallelCount() {
+  sudoku::BacktrackingSolver solver;
+  solver.Init();
+  char grid[81];
+  for (int keep = 45; keep >= 39; keep -= 3) {
+    under_constrained_grid(keep, grid);
+    solver.Set(grid);
+    long long expected = solver.dfs(0, true, true);
+    assert(expected > 1);
+    for (int threads = 1; threads <= 4; threads++) {
+      for (int split = 0; split <= 6; split += 3) {
+        solver.Set(grid);
+        assert(solver.ParallelCount(threads, split) == expected);
+      }
+    }
+  }
+}
+
+// unique, and removing any clue makes it ambiguous
+bool is_minimal(const string& puzzle) {
+  sudoku::BacktrackingSolver solver;
+  solver.Init();
+  char grid[81];
+  sudoku::Parse(puzzle, grid);
+  solver.Set(grid);
+  if (solver.CountUpTo(2) != 1) {
+    return false;
+  }
+  for (int i = 0; i < 81; i++) {
+    if (grid[i] != 0) {
+      char value = grid[i];
+      solver.Remove(i);
+      bool ambiguous = solver.CountUpTo(2) == 2;
+      solver.Place(i, value);
+      if (!ambiguous) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void testSudokuGenerator() {
+  for (int threads = 1; threads <= 3; threads += 2) {
+    sudoku::Generator generator(threads, 2019);
+    for (int k = 0; k < 3; k++) {
+      string puzzle = generator.Generate(26);
+      assert(81 - count(puzzle.begin(), puzzle.end(), '0') <= 26);
+      assert(is_minimal(puzzle));
+    }
+    // out of reach, the generator gives up instead of looping
+    assert(generator.Generate(16).empty());
+    assert(generator.Generate(17, 5).empty());
+  }
+}
+
+void testSudokuIterative() {
+  sudoku::IterativeSolver iterative;
+  iterative.Init();
+  sudoku::HeapSolver heap;
+  heap.Init();
+  char grid[81];
+  for (auto& puzzle : read_sudoku17(20)) {
+    sudoku::Parse(puzzle, grid);
+    iterative.Set(grid);
+    assert(iterative.HasUniqueSolution());
+    assert(iterative.SolveOne() != nullptr && iterative.Solved());
+    heap.Set(grid);
+    heap.SolveOne();
+    assert(iterative.to_string() == heap.to_string());
+  }
+  sudoku::BacktrackingSolver backtracking;
+  backtracking.Init();
+  for (int keep = 45; keep >= 36; keep -= 3) {
+    under_constrained_grid(keep, grid);
+    backtracking.Set(grid);
+    iterative.Set(grid);
+    assert(iterative.CountUpTo(LLONG_MAX) == backtracking.dfs(0, true, true));
+    assert(!iterative.HasUniqueSolution());
+  }
+  // the last cell of the first row has no candidate left
+  memset(grid, 0, sizeof(grid));
+  for (int i = 0; i < 8; i++) {
+    grid[i] = i + 1;
+  }
+  grid[17] = 9;
+  iterative.Set(grid);
+  assert(iterative.SolveOne() == nullptr);
+}
+
+void testSudoku() {
+  ifstream fin("Sudoku.txt");
+  string s, line;
+  while (fin >> line) {
+    s += line;
+  }
+  char grid[81];
+  sudoku::Parse(s, grid);
+
+  sudoku::BacktrackingSolver backtracking;
+  backtracking.Init();
+  backtracking.Set(grid);
+  assert(backtracking.HasUniqueSolution());
+  backtracking.Set(grid);
+  assert(backtracking.SolveOne() != nullptr && backtracking.Solved());
+  string solution = backtracking.to_string();
+
+  sudoku::HeapSolver heap;
+  heap.Init();
+  heap.Set(grid);
+  assert(heap.SolveOne() != nullptr && heap.Solved());
+  assert(heap.to_string() == solution);
+
+  vector<string> puzzles = read_sudoku17(5);
+  sudoku::BatchReport report = sudoku::RunBatch(heap, puzzles);
+  assert(report.latency.size() == puzzles.size());
+  assert(report.Percentile(0.5) <= report.Max());
+  assert(report.latency[report.Slowest(1)[0]] == report.Max());
+  sudoku::BatchReport empty = sudoku::RunBatch(heap, {});
+  assert(empty.Percentile(0.5) == 0 && empty.Max() == 0);
+  assert(empty.Slowest(1).empty());
+#ifdef SUDOKU_STATS
+  for (auto& stats : report.stats) {
+    assert(stats.nodes > 0 && stats.max_depth >= 64);
+    assert(stats.propagations >= stats.backtracks);
+  }
+#endif
+
+  testSudokuParallelCount();
+  testSudokuGenerator();
+  testSudokuIterative();
+}
+
+void benchmarkSudokuParallelCount() {
+  sudoku::BacktrackingSolver solver;
+  solver.Init();
+  char grid[81];
+  under_constrained_grid(33, grid);
+  solver.Set(grid);
+  auto start = chrono::steady_clock::now();
+  long long expected = solver.dfs(0, true, true);
+  cout << "sequential count " << expected << ": " << seconds_since(start)
+       << "s\n";
+  for (int threads = 1; threads <= 8; threads <<= 1) {
+    solver.Set(grid);
+    start = chrono::steady_clock::now();
+    long long ct = solver.ParallelCount(threads, 6);
+    assert(ct == expected);
+    cout << "parallel count, " << threads << " threads: "
+         << seconds_since(start) << "s\n";
+  }
+}
+
+void benchmarkSudokuGenerator() {
+  const int puzzles = 200;
+  for (int threads = 1; threads <= 4; threads <<= 1) {
+    sudoku::Generator generator(threads);
+    int clues = 0;
+    auto start = chrono::steady_clock::now();
+    for (int k = 0; k < puzzles; k++) {
+      string puzzle = generator.Generate();
+      clues += 81 - count(puzzle.begin(), puzzle.end(), '0');
+    }
+    double elapsed = seconds_since(start);
+    cout << "generator, " << threads << " threads: " << puzzles / elapsed
+         << " minimal puzzles/s, " << (double)clues / puzzles
+         << " clues on average, " << generator.checks / puzzles
+         << " checks per puzzle\n";
+  }
+}
+
+void benchmarkSudokuBatch() {
+  // the recursive solvers only get a prefix of the file
+  vector<string> puzzles = read_sudoku17(INT_MAX);
+  sudoku::IterativeSolver iterative;
+  iterative.Init();
+  cout << "iterative solver, " << puzzles.size()
+       << " puzzles of sudoku17.txt\n";
+  sudoku::RunBatch(iterative, puzzles).Print(cout, puzzles);
+  puzzles.resize(1000);
+  cout << "iterative solver, " << puzzles.size()
+       << " puzzles of sudoku17.txt\n";
+  sudoku::RunBatch(iterative, puzzles).Print(cout, puzzles);
+  sudoku::HeapSolver heap;
+  heap.Init();
+  cout << "heap solver, " << puzzles.size() << " puzzles of sudoku17.txt\n";
+  sudoku::RunBatch(heap, puzzles).Print(cout, puzzles);
+  puzzles.resize(50);
+  sudoku::BacktrackingSolver backtracking;
+  backtracking.Init();
+  cout << "backtracking solver, " << puzzles.size()
+       << " puzzles of sudoku17.txt\n";
+  sudoku::RunBatch(backtracking, puzzles).Print(cout, puzzles);
+}
+
+void benchmarkSudoku() {
+  benchmarkSudokuBatch();
+  benchmarkSudokuParallelCount();
+  benchmarkSudokuGenerator();
+}
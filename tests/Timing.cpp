@@ -0,0 +1,10 @@
+// the benchmarks of every *Test.cpp share this, they all end up in one
+// translation unit through test.cpp
+#pragma once
+#include <chrono>
+
+inline double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}